@@ -0,0 +1,129 @@
+# Generates a constexpr parameter table from the GUI layout.
+#
+#   cmake -DLAYOUT=def.json -DOUTPUT=params_generated.h -P gen_params.cmake
+#
+# Every distinct "param" in the layout's "controls" becomes one ParamId entry.
+# Optional per-control keys "min", "max", "default" and "formatter" fill in the
+# metadata; the first control that names a param and sets a key wins.
+# "formatter" is emitted verbatim as formatters::<name> (see src/gui/formatters.h).
+
+if(NOT LAYOUT OR NOT OUTPUT)
+    message(FATAL_ERROR "gen_params.cmake: LAYOUT and OUTPUT must be set")
+endif()
+
+# a layout number as a C++ float literal: "5" -> 5.0f, "0.5" / ".5" / "1e3" -> 0.5f / .5f / 1e3f
+function(float_literal out value what)
+    if(NOT value MATCHES "^[-+]?([0-9]+\\.?[0-9]*|\\.[0-9]+)([eE][-+]?[0-9]+)?$")
+        message(FATAL_ERROR "${LAYOUT}: ${what} '${value}' is not a number")
+    endif()
+    if(value MATCHES "[.eE]")
+        set(${out} "${value}f" PARENT_SCOPE)
+    else()
+        set(${out} "${value}.0f" PARENT_SCOPE)
+    endif()
+endfunction()
+
+file(READ "${LAYOUT}" layout_json)
+string(JSON control_count LENGTH "${layout_json}" controls)
+
+set(names)
+math(EXPR last "${control_count} - 1")
+foreach(i RANGE 0 ${last})
+    string(JSON param ERROR_VARIABLE err GET "${layout_json}" controls ${i} param)
+    if(err OR param STREQUAL "")
+        continue()
+    endif()
+    if(NOT param MATCHES "^[A-Za-z_][A-Za-z0-9_]*$")
+        message(FATAL_ERROR "${LAYOUT}: control #${i} param '${param}' is not a valid identifier")
+    endif()
+
+    list(FIND names "${param}" found)
+    if(found EQUAL -1)
+        list(APPEND names "${param}")
+        set(min_${param} "0")
+        set(max_${param} "1")
+        set(def_${param} "0")
+        set(fmt_${param} "")
+    endif()
+
+    foreach(key min max default formatter)
+        string(JSON value ERROR_VARIABLE err GET "${layout_json}" controls ${i} ${key})
+        if(err)
+            continue()
+        endif()
+        if(key STREQUAL "formatter")
+            if(fmt_${param} STREQUAL "")
+                set(fmt_${param} "${value}")
+            endif()
+        elseif(NOT seen_${key}_${param})
+            set(seen_${key}_${param} TRUE)
+            if(key STREQUAL "default")
+                set(def_${param} "${value}")
+            else()
+                set(${key}_${param} "${value}")
+            endif()
+        endif()
+    endforeach()
+endforeach()
+
+set(enum_body "")
+set(table_body "")
+foreach(name ${names})
+    string(APPEND enum_body "    ${name},\n")
+    if(fmt_${name} STREQUAL "")
+        set(format_fn "nullptr")
+    else()
+        set(format_fn "&formatters::${fmt_${name}}::format")
+    endif()
+    float_literal(min_lit "${min_${name}}" "${name} min")
+    float_literal(max_lit "${max_${name}}" "${name} max")
+    float_literal(def_lit "${def_${name}}" "${name} default")
+    string(APPEND table_body "    { \"${name}\", ${min_lit}, ${max_lit}, ${def_lit}, \"${fmt_${name}}\", ${format_fn} },\n")
+endforeach()
+# ISO C++ has no zero-size arrays: a layout without params gets one unnamed
+# entry past the end, which no ParamId reaches
+if(table_body STREQUAL "")
+    set(table_body "    { \"\", 0.0f, 0.0f, 0.0f, \"\", nullptr }, // sentinel, no params\n")
+endif()
+
+set(content "// generated from ${LAYOUT} by cmake/gen_params.cmake -- do not edit
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include \"formatters.h\"
+
+enum class ParamId : uint32_t {
+${enum_body}    Count
+};
+
+constexpr size_t kParamCount = static_cast<size_t>(ParamId::Count);
+
+struct ParamInfo {
+    const char* name;
+    float min;
+    float max;
+    float def;
+    const char* formatter; // name from the layout, empty if none
+    FormatFn format;       // compile-time instantiation of that formatter, or nullptr
+};
+
+inline constexpr ParamInfo kParamInfo[kParamCount > 0 ? kParamCount : 1] = {
+${table_body}};
+
+/// load-time lookup only; the hot path uses ParamId directly
+constexpr int paramIdFromName(std::string_view name) {
+    for (size_t i = 0; i < kParamCount; ++i)
+        if (name == kParamInfo[i].name) return static_cast<int>(i);
+    return -1;
+}
+")
+
+# only touch the output when it changes, so dependents don't rebuild needlessly
+if(EXISTS "${OUTPUT}")
+    file(READ "${OUTPUT}" previous)
+    if(previous STREQUAL content)
+        return()
+    endif()
+endif()
+file(WRITE "${OUTPUT}" "${content}")
@@ -1,10 +1,36 @@
 
 #include <guikit.h>
+#include <cstring>
 
-int main() {
+// --render-thread: present from the shared render thread instead of this loop
+// --low-latency / --adaptive: present policy (default: power-saving vsync)
+// --profile:       print frame timing, to compare modes and policies
+// --capture FILE:  record every frame and input to FILE for tools/replay
+static constexpr double kIdleWaitSeconds = 0.02;
+
+int main(int argc, char** argv) {
     printf( "[SubaAudioDevice] standalone demo\n" );
+    RenderMode mode = RenderMode::CallerThread;
+    PresentPolicy policy = PresentPolicy::PowerSaving;
+    bool profile = false;
+    const char* capturePath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--render-thread") == 0) mode = RenderMode::RenderThread;
+        else if (strcmp(argv[i], "--low-latency") == 0) policy = PresentPolicy::LowLatency;
+        else if (strcmp(argv[i], "--adaptive") == 0) policy = PresentPolicy::Adaptive;
+        else if (strcmp(argv[i], "--profile") == 0) profile = true;
+        else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc) capturePath = argv[++i];
+    }
+
     PlatformWindow win(800,600,"gfxkit");
-    Renderer renderer(win.nativeParent(),800,600);
+    Renderer renderer(win.nativeParent(),800,600,mode);
+    renderer.setProfiling(profile);
+    // before any texture is made, so the capture has everything a replay needs
+    FrameCapture capture;
+    if (capturePath && capture.open(capturePath, renderer.nativePixelFormat()))
+        renderer.setCapture(&capture);
+    if (!renderer.setPresentPolicy(policy))
+        printf( "present policy not supported here, staying on power-saving vsync\n" );
 
     // Create a solid white texture
     // unsigned int texId = renderer.createSolidTexture(255,0,0,255);
@@ -17,23 +43,61 @@ int main() {
     // };
 
     // use the json widget layout loader
-    std::vector<Widget*> widgets = loadGUI( renderer, "def.json" );
+    GuiParamStore params;
+    initParamDefaults(params);
+    textVariables()["gVersionStr"] = "SubaGuiCpp demo";
+    WidgetTable widgets = loadGUI( renderer, "def.json" );
+    for (uint32_t id = 0; id < kParamCount; ++id) params.markDirty(id);
 
     AppEvents appEvents;
     win.pubsub.addListener(&appEvents);
-    appEvents.addHandler(EventType::KeyDown, [&widgets, &renderer](const Event& e){
+    for (EventType t : { EventType::MouseDown, EventType::MouseUp, EventType::MouseMove, EventType::KeyDown })
+        appEvents.addHandler(t, [&renderer](const Event& e){ renderer.noteInput(e.timeNs); });
+    if (capture.isOpen())
+        for (EventType t : { EventType::MouseDown, EventType::MouseUp, EventType::MouseMove, EventType::KeyDown, EventType::KeyUp, EventType::Resize })
+            appEvents.addHandler(t, [&capture](const Event& e){ capture.event(toCapture(e)); });
+    int winW = 800, winH = 600;
+    appEvents.addHandler(EventType::Resize, [&widgets, &renderer, &winW, &winH](const Event& e){
+        winW = e.width;
+        winH = e.height;
+        renderer.resize(winW, winH);
+        widgets.resize((float)winW, (float)winH); // only anchored/relative controls move
+        widgets.redraw = true; // the surface changed even if no widget did
+    });
+    appEvents.addHandler(EventType::KeyDown, [&widgets, &renderer, &params, &winW, &winH](const Event& e){
+        if (e.character == 's' && !e.keyRepeat) {
+            std::vector<uint8_t> rgba;
+            int w = 0, h = 0;
+            if (widgets.capture(renderer, (float)winW, (float)winH, 1.0f, rgba, w, h) && savePNG("screenshot.png", rgba, w, h))
+                printf( "saved screenshot.png (%dx%d)\n", w, h );
+            else
+                printf( "screenshot not supported by this renderer\n" );
+        }
         if (e.character == 'r' && !e.keyRepeat) {
             printf( "reload\n" );
-            widgets = loadGUI( renderer, "def.json" );
+            widgets = loadGUI( renderer, "def.json", true );
+            widgets.resize((float)winW, (float)winH);
+            for (uint32_t id = 0; id < kParamCount; ++id) params.markDirty(id);
         }
     });
 
     while(appEvents.running) {
-        win.poll();
+        // nothing changing on screen: sleep until input, waking now and then for automation
+        if (widgets.needsDraw(renderer)) win.poll();
+        else win.waitEvents(kIdleWaitSeconds);
 
-        for (auto* w : widgets) {
-            renderer.addQuad(w->quad, w->texId);
-        }
+        // pick up processor automation; only widgets bound to a changed param are touched
+        params.guiPoll();
+        params.consumeDirty([&widgets](uint32_t id, float value) {
+            widgets.applyParam((int32_t)id, value);
+        });
+
+        if (!widgets.needsDraw(renderer)) continue;
+        widgets.draw(renderer);
         renderer.drawFrame();
     }
+    if (capture.isOpen()) {
+        renderer.setCapture(nullptr);
+        printf( "captured %llu frames, %zu bytes\n", (unsigned long long)capture.framesWritten(), capture.bytesWritten() );
+    }
 }
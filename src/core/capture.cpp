@@ -0,0 +1,337 @@
+#include "capture.h"
+#include <cstring>
+
+static const char kMagic[4] = { 'S', 'U', 'B', 'C' };
+static constexpr uint32_t kVersion = 1;
+
+static_assert(sizeof(Quad) == 80, "quads are written as-is");
+
+bool FrameCapture::open(const char* path, PixelFormat format) {
+    close();
+    fp = fopen(path, "wb");
+    if (!fp) {
+        printf("ERROR: can't write capture %s\n", path);
+        return false;
+    }
+    put(kMagic, 4);
+    put(kVersion);
+    put((uint32_t)format);
+    return true;
+}
+
+void FrameCapture::close() {
+    if (!fp) return;
+    fclose(fp);
+    fp = nullptr;
+    lastQuads.clear();
+    lastTex.clear();
+}
+
+void FrameCapture::begin(CaptureOp op, size_t payloadBytes) {
+    put((uint32_t)op);
+    put((uint32_t)payloadBytes);
+}
+
+void FrameCapture::put(const void* data, size_t bytes) {
+    if (!fp || !bytes) return;
+    if (fwrite(data, 1, bytes, fp) != bytes) {
+        printf("ERROR: capture write failed, stopping the capture\n");
+        close();
+        return;
+    }
+    written += bytes;
+}
+
+size_t FrameCapture::levelsBytes(const Texture* levels, int levelCount) {
+    size_t bytes = 4;
+    for (int i = 0; i < levelCount; ++i) bytes += 8 + (size_t)levels[i].width * levels[i].height * 4;
+    return bytes;
+}
+
+void FrameCapture::putLevels(const Texture* levels, int levelCount) {
+    put((int32_t)levelCount);
+    for (int i = 0; i < levelCount; ++i) {
+        put((int32_t)levels[i].width);
+        put((int32_t)levels[i].height);
+        put(levels[i].data, (size_t)levels[i].width * levels[i].height * 4);
+    }
+}
+
+void FrameCapture::resize(int width, int height, float scale) {
+    if (!fp) return;
+    begin(CaptureOp::Resize, 12);
+    put((int32_t)width);
+    put((int32_t)height);
+    put(scale);
+}
+
+void FrameCapture::createTexture(unsigned int id, const Texture* levels, int levelCount) {
+    if (!fp) return;
+    begin(CaptureOp::CreateTexture, 4 + levelsBytes(levels, levelCount));
+    put((uint32_t)id);
+    putLevels(levels, levelCount);
+}
+
+void FrameCapture::createSolid(unsigned int id, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+    if (!fp) return;
+    const uint8_t rgba[4] = { r, g, b, a };
+    begin(CaptureOp::CreateSolid, 8);
+    put((uint32_t)id);
+    put(rgba, 4);
+}
+
+void FrameCapture::reserveTexture(unsigned int id, int width, int height, bool mipmapped) {
+    if (!fp) return;
+    begin(CaptureOp::ReserveTexture, 16);
+    put((uint32_t)id);
+    put((int32_t)width);
+    put((int32_t)height);
+    put((uint32_t)mipmapped);
+}
+
+void FrameCapture::streamTexture(unsigned int id, const TextureUpload& upload) {
+    if (!fp) return;
+    const int n = (int)upload.levels.size();
+    begin(CaptureOp::StreamTexture, 4 + levelsBytes(upload.levels.data(), n));
+    put((uint32_t)id);
+    putLevels(upload.levels.data(), n);
+}
+
+void FrameCapture::createCompressed(unsigned int id, const CompressedTexture& tex) {
+    if (!fp) return;
+    begin(CaptureOp::CreateCompressed, 20 + tex.data.size());
+    put((uint32_t)id);
+    put((uint32_t)tex.format);
+    put((int32_t)tex.width);
+    put((int32_t)tex.height);
+    put((uint32_t)tex.premultiplied);
+    put(tex.data.data(), tex.data.size());
+}
+
+void FrameCapture::setTextureShader(unsigned int id, TextureShader shader) {
+    if (!fp) return;
+    begin(CaptureOp::SetTextureShader, 8);
+    put((uint32_t)id);
+    put((uint32_t)shader);
+}
+
+void FrameCapture::destroyTexture(unsigned int id) {
+    if (!fp) return;
+    begin(CaptureOp::DestroyTexture, 4);
+    put((uint32_t)id);
+}
+
+void FrameCapture::createTarget(unsigned int id, int width, int height) {
+    if (!fp) return;
+    begin(CaptureOp::CreateTarget, 12);
+    put((uint32_t)id);
+    put((int32_t)width);
+    put((int32_t)height);
+}
+
+void FrameCapture::renderToTarget(unsigned int id, const Quad* quads, const unsigned int* textureIds, size_t quadCount) {
+    if (!fp) return;
+    begin(CaptureOp::RenderToTarget, 8 + quadCount * (sizeof(Quad) + 4));
+    put((uint32_t)id);
+    put((uint32_t)quadCount);
+    put(quads, quadCount * sizeof(Quad));
+    for (size_t i = 0; i < quadCount; ++i) put((uint32_t)textureIds[i]);
+}
+
+void FrameCapture::destroyTarget(unsigned int id) {
+    if (!fp) return;
+    begin(CaptureOp::DestroyTarget, 4);
+    put((uint32_t)id);
+}
+
+// only the quads that differ from the same slot last frame are written
+void FrameCapture::frame(uint64_t submitNs, const Quad* quads, const unsigned int* textureIds, size_t quadCount) {
+    if (!fp) return;
+    changed.assign((quadCount + 7) / 8, 0);
+    size_t changes = 0;
+    for (size_t i = 0; i < quadCount; ++i) {
+        if (i < lastQuads.size() && lastTex[i] == textureIds[i] && memcmp(&lastQuads[i], &quads[i], sizeof(Quad)) == 0) continue;
+        changed[i / 8] |= (uint8_t)(1u << (i % 8));
+        ++changes;
+    }
+    begin(CaptureOp::Frame, 12 + changed.size() + changes * (sizeof(Quad) + 4));
+    put(submitNs);
+    put((uint32_t)quadCount);
+    put(changed.data(), changed.size());
+    for (size_t i = 0; i < quadCount; ++i) {
+        if (!(changed[i / 8] & (1u << (i % 8)))) continue;
+        put(quads[i]);
+        put((uint32_t)textureIds[i]);
+    }
+    lastQuads.assign(quads, quads + quadCount);
+    lastTex.assign(textureIds, textureIds + quadCount);
+    ++frames;
+}
+
+void FrameCapture::event(const CaptureEvent& e) {
+    if (!fp) return;
+    begin(CaptureOp::Event, sizeof(CaptureEvent));
+    put(e);
+}
+
+// ---- reading ----
+
+bool CaptureReader::open(const char* path) {
+    fp = fopen(path, "rb");
+    if (!fp) {
+        printf("ERROR: can't open capture %s\n", path);
+        return false;
+    }
+    char magic[4];
+    uint32_t version = 0, pixelFormat = 0;
+    if (fread(magic, 1, 4, fp) != 4 || memcmp(magic, kMagic, 4) != 0 ||
+        fread(&version, 4, 1, fp) != 1 || fread(&pixelFormat, 4, 1, fp) != 1) {
+        printf("ERROR: %s is not a capture\n", path);
+        return false;
+    }
+    if (version != kVersion) {
+        printf("ERROR: %s is capture version %u, this build reads %u\n", path, version, kVersion);
+        return false;
+    }
+    format = (PixelFormat)pixelFormat;
+    return true;
+}
+
+namespace {
+// bounds-checked cursor over one record's payload
+struct RecordCursor {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool ok = true;
+
+    bool take(void* out, size_t bytes) {
+        if ((size_t)(end - p) < bytes) { ok = false; return false; }
+        memcpy(out, p, bytes);
+        p += bytes;
+        return true;
+    }
+    template <typename T> T get() { T v{}; take(&v, sizeof(T)); return v; }
+
+    void levels(CaptureRecord& r) {
+        const int32_t n = get<int32_t>();
+        r.levels.clear();
+        r.pixels.clear();
+        if (n < 0 || n > 32) { ok = false; return; }
+        // sizes first, so the pixel storage is allocated once and levels can point into it
+        const uint8_t* start = p;
+        size_t total = 0;
+        for (int32_t i = 0; i < n && ok; ++i) {
+            const int32_t w = get<int32_t>(), h = get<int32_t>();
+            const size_t bytes = (size_t)(w > 0 ? w : 0) * (h > 0 ? h : 0) * 4;
+            if (w <= 0 || h <= 0 || (size_t)(end - p) < bytes) { ok = false; return; }
+            p += bytes;
+            total += bytes;
+        }
+        r.pixels.resize(total);
+        p = start;
+        size_t offset = 0;
+        for (int32_t i = 0; i < n; ++i) {
+            const int32_t w = get<int32_t>(), h = get<int32_t>();
+            const size_t bytes = (size_t)w * h * 4;
+            take(r.pixels.data() + offset, bytes);
+            r.levels.push_back(Texture(w, h, r.pixels.data() + offset));
+            offset += bytes;
+        }
+    }
+};
+}
+
+bool CaptureReader::next(CaptureRecord& r) {
+    if (!fp) return false;
+    uint32_t header[2];
+    if (fread(header, 4, 2, fp) != 2) return false; // clean end
+    payload.resize(header[1]);
+    if (fread(payload.data(), 1, payload.size(), fp) != payload.size()) {
+        printf("ERROR: capture ends inside a record\n");
+        return false;
+    }
+    RecordCursor c{ payload.data(), payload.data() + payload.size() };
+    r.op = (CaptureOp)header[0];
+    switch (r.op) {
+    case CaptureOp::Resize:
+        r.width = c.get<int32_t>();
+        r.height = c.get<int32_t>();
+        r.scale = c.get<float>();
+        break;
+    case CaptureOp::CreateTexture:
+    case CaptureOp::StreamTexture:
+        r.id = c.get<uint32_t>();
+        c.levels(r);
+        break;
+    case CaptureOp::CreateSolid:
+        r.id = c.get<uint32_t>();
+        c.take(r.rgba, 4);
+        break;
+    case CaptureOp::ReserveTexture:
+        r.id = c.get<uint32_t>();
+        r.width = c.get<int32_t>();
+        r.height = c.get<int32_t>();
+        r.value = c.get<uint32_t>();
+        break;
+    case CaptureOp::CreateCompressed:
+        r.id = c.get<uint32_t>();
+        r.compressed.format = (CompressedFormat)c.get<uint32_t>();
+        r.compressed.width = c.get<int32_t>();
+        r.compressed.height = c.get<int32_t>();
+        r.compressed.premultiplied = c.get<uint32_t>() != 0;
+        r.compressed.data.assign(c.p, c.end);
+        c.p = c.end;
+        break;
+    case CaptureOp::SetTextureShader:
+        r.id = c.get<uint32_t>();
+        r.value = c.get<uint32_t>();
+        break;
+    case CaptureOp::CreateTarget:
+        r.id = c.get<uint32_t>();
+        r.width = c.get<int32_t>();
+        r.height = c.get<int32_t>();
+        break;
+    case CaptureOp::RenderToTarget: {
+        r.id = c.get<uint32_t>();
+        const uint32_t n = c.get<uint32_t>();
+        if ((size_t)(c.end - c.p) != (size_t)n * (sizeof(Quad) + 4)) { c.ok = false; break; }
+        r.quads.resize(n);
+        r.tex.resize(n);
+        c.take(r.quads.data(), n * sizeof(Quad));
+        for (uint32_t i = 0; i < n; ++i) r.tex[i] = c.get<uint32_t>();
+        break;
+    }
+    case CaptureOp::DestroyTarget:
+    case CaptureOp::DestroyTexture:
+        r.id = c.get<uint32_t>();
+        break;
+    case CaptureOp::Frame: {
+        r.timeNs = c.get<uint64_t>();
+        const uint32_t n = c.get<uint32_t>();
+        const uint8_t* bits = c.p;
+        if ((size_t)(c.end - c.p) < (n + 7) / 8) { c.ok = false; break; }
+        c.p += (n + 7) / 8;
+        lastQuads.resize(n);
+        lastTex.resize(n, 0);
+        for (uint32_t i = 0; i < n && c.ok; ++i) {
+            if (!(bits[i / 8] & (1u << (i % 8)))) continue;
+            c.take(&lastQuads[i], sizeof(Quad));
+            lastTex[i] = c.get<uint32_t>();
+        }
+        r.quads = lastQuads;
+        r.tex = lastTex;
+        break;
+    }
+    case CaptureOp::Event:
+        c.take(&r.event, sizeof(CaptureEvent));
+        break;
+    default:
+        printf("WARNING: skipping unknown capture record %u\n", header[0]);
+        return next(r);
+    }
+    if (!c.ok || c.p != c.end) {
+        printf("ERROR: damaged capture record (op %u)\n", header[0]);
+        return false;
+    }
+    return true;
+}
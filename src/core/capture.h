@@ -0,0 +1,137 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "renderer.h"
+
+// Renderer call capture, for turning a slow frame a user sees into a file we
+// can replay, bisect and benchmark (tools/replay).
+//
+// With a FrameCapture attached (Renderer::setCapture) the renderer writes
+// every call that changes what ends up on screen: texture and render target
+// creation with their pixels, resizes, and each drawFrame() with its quads
+// in draw order.  The host adds its input events, so a replay shows what the
+// user was doing when a frame was slow.  Ids are the ones the recording
+// renderer handed out; a replay maps them to its own.
+//
+// File: "SUBC", format version, the recording renderer's PixelFormat, then
+// records of { op, payload bytes, payload }, native byte order.  A frame is
+// stored against the previous one: a bit per quad that changed, then only
+// those quads, so a static panel costs a few bytes per frame.
+
+/// input as the host saw it (mirrors the platform Event, which core doesn't see)
+struct CaptureEvent {
+    uint32_t type = 0;   // EventType
+    int32_t x = 0, y = 0;
+    int32_t width = 0, height = 0;
+    int32_t key = 0;
+    int32_t character = 0;
+    uint32_t keyRepeat = 0;
+    uint32_t button = 0; // MouseButton
+    uint32_t pad = 0;
+    uint64_t timeNs = 0;
+};
+static_assert(sizeof(CaptureEvent) == 48, "CaptureEvent is written as-is");
+
+enum class CaptureOp : uint32_t {
+    Resize = 1,       // int32 w, h; float scale
+    CreateTexture,    // uint32 id; levels
+    CreateSolid,      // uint32 id; uint8 r, g, b, a
+    ReserveTexture,   // uint32 id; int32 w, h; uint32 mipmapped
+    StreamTexture,    // uint32 id; levels (none: the data isn't coming)
+    CreateCompressed, // uint32 id; uint32 format; int32 w, h; uint32 premultiplied; bytes
+    SetTextureShader, // uint32 id; uint32 TextureShader
+    CreateTarget,     // uint32 id; int32 w, h
+    RenderToTarget,   // uint32 id; uint32 n; n quads; n uint32 texture ids
+    DestroyTarget,    // uint32 id
+    Frame,            // uint64 submitNs; uint32 n; changed bitmap; changed quads and ids
+    Event,            // CaptureEvent
+    DestroyTexture,   // uint32 id
+};
+// levels: int32 count, then per level int32 w, h and w * h * 4 bytes
+
+class FrameCapture {
+public:
+    FrameCapture() = default;
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+    ~FrameCapture() { close(); }
+
+    /// format: the recording renderer's nativePixelFormat(), which texel data is in
+    bool open(const char* path, PixelFormat format);
+    void close();
+    bool isOpen() const { return fp != nullptr; }
+    size_t bytesWritten() const { return written; }
+    uint64_t framesWritten() const { return frames; }
+
+    // called by the renderer
+    void resize(int width, int height, float scale);
+    void createTexture(unsigned int id, const Texture* levels, int levelCount);
+    void createSolid(unsigned int id, uint8_t r, uint8_t g, uint8_t b, uint8_t a);
+    void reserveTexture(unsigned int id, int width, int height, bool mipmapped);
+    void streamTexture(unsigned int id, const TextureUpload& upload);
+    void createCompressed(unsigned int id, const CompressedTexture& tex);
+    void setTextureShader(unsigned int id, TextureShader shader);
+    void destroyTexture(unsigned int id);
+    void createTarget(unsigned int id, int width, int height);
+    void renderToTarget(unsigned int id, const Quad* quads, const unsigned int* textureIds, size_t quadCount);
+    void destroyTarget(unsigned int id);
+    void frame(uint64_t submitNs, const Quad* quads, const unsigned int* textureIds, size_t quadCount);
+
+    // called by the host
+    void event(const CaptureEvent& e);
+
+private:
+    FILE* fp = nullptr;
+    size_t written = 0;
+    uint64_t frames = 0;
+    // the last frame, which the next one is stored against
+    std::vector<Quad> lastQuads;
+    std::vector<unsigned int> lastTex;
+    std::vector<uint8_t> changed;
+
+    void begin(CaptureOp op, size_t payloadBytes);
+    void put(const void* data, size_t bytes);
+    template <typename T> void put(const T& v) { put(&v, sizeof(T)); }
+    static size_t levelsBytes(const Texture* levels, int levelCount);
+    void putLevels(const Texture* levels, int levelCount);
+};
+
+/// one record of a capture, decoded; frames come back whole
+struct CaptureRecord {
+    CaptureOp op = CaptureOp::Resize;
+    unsigned int id = 0;
+    int width = 0, height = 0;
+    float scale = 1.0f;
+    uint32_t value = 0;       // mipmapped / TextureShader
+    uint8_t rgba[4] = {};     // CreateSolid
+    uint64_t timeNs = 0;      // Frame: when it was submitted
+    std::vector<Texture> levels;       // point into pixels
+    std::vector<char> pixels;
+    CompressedTexture compressed;
+    std::vector<Quad> quads;           // Frame / RenderToTarget
+    std::vector<unsigned int> tex;
+    CaptureEvent event;
+};
+
+class CaptureReader {
+public:
+    CaptureReader() = default;
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+    ~CaptureReader() { if (fp) fclose(fp); }
+
+    /// false (with a printed reason) if path isn't a capture this build can read
+    bool open(const char* path);
+    PixelFormat pixelFormat() const { return format; }
+
+    /// the next record; false at the end of the file or at a damaged record
+    bool next(CaptureRecord& r);
+
+private:
+    FILE* fp = nullptr;
+    PixelFormat format = PixelFormat::RGBA8;
+    std::vector<uint8_t> payload;
+    std::vector<Quad> lastQuads;
+    std::vector<unsigned int> lastTex;
+};
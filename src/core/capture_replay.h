@@ -0,0 +1,102 @@
+#pragma once
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "capture.h"
+
+// Re-executes capture records (capture.h) on anything with Renderer's
+// interface: Renderer itself, or SoftRenderer for headless runs.  Ids in the
+// records are the recording renderer's; they are mapped to the ones this
+// renderer hands out.
+
+template <typename R>
+class CaptureReplay {
+public:
+    /// recorded: the capture's pixelFormat(); texels are swizzled if R differs
+    CaptureReplay(R& renderer, PixelFormat recorded)
+        : r(renderer), swizzle(recorded != renderer.nativePixelFormat()) {}
+
+    /// one record.  Textures are only created when firstPass, so a capture can
+    /// be looped; targets and frames run every pass.  A Frame's quads are
+    /// queued and true returned: the caller calls drawFrame() (and times it).
+    /// rec's texture ids are mapped in place
+    bool apply(CaptureRecord& rec, bool firstPass) {
+        switch (rec.op) {
+        case CaptureOp::Resize:
+            r.setContentScale(rec.scale);
+            r.resize(rec.width, rec.height);
+            break;
+        case CaptureOp::CreateTexture:
+            if (!firstPass) break;
+            convert(rec);
+            ids[rec.id] = r.createTexture(rec.levels.data(), (int)rec.levels.size());
+            break;
+        case CaptureOp::CreateSolid:
+            if (firstPass) ids[rec.id] = r.createSolidTexture(rec.rgba[0], rec.rgba[1], rec.rgba[2], rec.rgba[3]);
+            break;
+        case CaptureOp::ReserveTexture:
+            if (firstPass) ids[rec.id] = r.reserveTexture(rec.width, rec.height, rec.value != 0);
+            break;
+        case CaptureOp::StreamTexture: {
+            if (!firstPass) break;
+            convert(rec);
+            TextureUpload upload;
+            upload.levels = rec.levels;
+            upload.owner = std::make_shared<std::vector<char>>(std::move(rec.pixels)); // levels point into it
+            r.streamTexture(map(rec.id), std::move(upload));
+            break;
+        }
+        case CaptureOp::CreateCompressed:
+            if (!firstPass) break;
+            ids[rec.id] = r.createTexture(rec.compressed);
+            if (!ids[rec.id]) printf("NOTE: compressed texture %u can't be drawn here; its quads are skipped\n", rec.id);
+            break;
+        case CaptureOp::SetTextureShader:
+            if (firstPass) r.setTextureShader(map(rec.id), (TextureShader)rec.value);
+            break;
+        case CaptureOp::CreateTarget:
+            if (ids.count(rec.id)) break; // still alive from the last pass
+            ids[rec.id] = r.createRenderTarget(rec.width, rec.height);
+            break;
+        case CaptureOp::RenderToTarget:
+            mapAll(rec.tex);
+            r.renderToTarget(map(rec.id), rec.quads.data(), rec.tex.data(), rec.quads.size());
+            break;
+        case CaptureOp::DestroyTarget:
+            r.destroyRenderTarget(map(rec.id));
+            ids.erase(rec.id);
+            break;
+        case CaptureOp::DestroyTexture:
+            // textures only exist from the first pass on, so a looped capture keeps
+            // them; the recorded id may come back for a new texture, which remaps it
+            break;
+        case CaptureOp::Frame:
+            mapAll(rec.tex);
+            for (size_t i = 0; i < rec.quads.size(); ++i)
+                if (rec.tex[i]) r.addQuad(rec.quads[i], rec.tex[i]);
+            return true;
+        case CaptureOp::Event:
+            break;
+        }
+        return false;
+    }
+
+    /// this renderer's id for a recorded one; 0 if it was never created here
+    unsigned int map(unsigned int id) const {
+        auto it = ids.find(id);
+        return it == ids.end() ? 0 : it->second;
+    }
+
+private:
+    R& r;
+    bool swizzle;
+    std::unordered_map<unsigned int, unsigned int> ids;
+
+    void mapAll(std::vector<unsigned int>& tex) const {
+        for (unsigned int& t : tex) t = map(t);
+    }
+    // texels were recorded in the recording backend's channel order
+    void convert(CaptureRecord& rec) const {
+        if (swizzle) convertPixels((uint8_t*)rec.pixels.data(), rec.pixels.size() / 4, PixelFormat::BGRA8, false);
+    }
+};
@@ -0,0 +1,97 @@
+#include "compressed_texture.h"
+
+#include <cstdio>
+#include <cstring>
+
+// KTX2 layout, all little-endian:
+//   12-byte identifier
+//   u32 vkFormat, typeSize, pixelWidth, pixelHeight, pixelDepth,
+//       layerCount, faceCount, levelCount, supercompressionScheme
+//   u32 dfdByteOffset, dfdByteLength, kvdByteOffset, kvdByteLength
+//   u64 sgdByteOffset, sgdByteLength
+//   levelCount x { u64 byteOffset, byteLength, uncompressedByteLength }
+
+static const uint8_t kKTX2Identifier[12] = {
+    0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+};
+
+static const uint32_t kVkFormatBC7Unorm  = 145;
+static const uint32_t kVkFormatETC2Unorm = 151;
+static const uint8_t kDFDFlagPremultiplied = 1; // KHR_DF_FLAG_ALPHA_PREMULTIPLIED
+
+static uint32_t readU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t readU64(const uint8_t* p) {
+    return (uint64_t)readU32(p) | ((uint64_t)readU32(p + 4) << 32);
+}
+
+const char* compressedSuffix(CompressedFormat format) {
+    switch (format) {
+    case CompressedFormat::ETC2_RGBA8: return ".etc2.ktx2";
+    case CompressedFormat::BC7_RGBA:   return ".bc7.ktx2";
+    }
+    return ".ktx2";
+}
+
+size_t compressedLevelSize(int width, int height) {
+    return (size_t)((width + 3) / 4) * (size_t)((height + 3) / 4) * 16;
+}
+
+bool loadKTX2(const char* filename, CompressedTexture& out) {
+    FILE* fp = fopen(filename, "rb");
+    if (!fp) return false; // absent variant is the normal case, not an error
+
+    uint8_t header[104];
+    size_t got = fread(header, 1, sizeof(header), fp);
+    if (got < 80 + 24 || memcmp(header, kKTX2Identifier, sizeof(kKTX2Identifier)) != 0) {
+        printf("ERROR: %s is not a KTX2 file\n", filename);
+        fclose(fp);
+        return false;
+    }
+
+    uint32_t vkFormat = readU32(header + 12);
+    uint32_t width    = readU32(header + 20);
+    uint32_t height   = readU32(header + 24);
+    uint32_t depth    = readU32(header + 28);
+    uint32_t layers   = readU32(header + 32);
+    uint32_t faces    = readU32(header + 36);
+    uint32_t scheme   = readU32(header + 44);
+    uint32_t dfdOffset = readU32(header + 48);
+    uint64_t levelOffset = readU64(header + 80);
+    uint64_t levelLength = readU64(header + 88);
+
+    const char* problem = nullptr;
+    if (vkFormat == kVkFormatETC2Unorm) out.format = CompressedFormat::ETC2_RGBA8;
+    else if (vkFormat == kVkFormatBC7Unorm) out.format = CompressedFormat::BC7_RGBA;
+    else problem = "unsupported vkFormat (want ETC2_R8G8B8A8_UNORM or BC7_UNORM)";
+    if (!problem && scheme != 0) problem = "supercompressed (re-encode without zstd/basis)";
+    if (!problem && (depth > 1 || layers > 1 || faces != 1)) problem = "not a plain 2D texture";
+    if (!problem && (width == 0 || height == 0 || width > 16384 || height > 16384)) problem = "bad size";
+    if (!problem && levelLength != compressedLevelSize((int)width, (int)height)) problem = "level 0 size mismatch";
+    if (problem) {
+        printf("ERROR: %s: %s\n", filename, problem);
+        fclose(fp);
+        return false;
+    }
+
+    // basic descriptor block: totalSize, vendor/type, version/size, then model, primaries, transfer, flags
+    uint8_t dfd[16] = {};
+    out.premultiplied = dfdOffset && fseek(fp, (long)dfdOffset, SEEK_SET) == 0 &&
+                        fread(dfd, 1, sizeof(dfd), fp) == sizeof(dfd) &&
+                        (dfd[15] & kDFDFlagPremultiplied);
+
+    out.width = (int)width;
+    out.height = (int)height;
+    out.data.resize((size_t)levelLength);
+    bool ok = fseek(fp, (long)levelOffset, SEEK_SET) == 0 &&
+              fread(out.data.data(), 1, out.data.size(), fp) == out.data.size();
+    fclose(fp);
+    if (!ok) {
+        printf("ERROR: %s: truncated level data\n", filename);
+        out.data.clear();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Block-compressed textures produced offline (e.g. `toktx --encode` or
+// `basisu -ktx2` without supercompression) and shipped as KTX2 next to the
+// PNG.  They stay compressed in VRAM: ETC2 for GLES3 devices like the Pi,
+// BC7 for desktop GPUs.  Both are 16 bytes per 4x4 block, i.e. 1 byte per
+// pixel instead of 4.  Like the PNG path, the texels must be premultiplied.
+
+enum class CompressedFormat {
+    ETC2_RGBA8, // VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK
+    BC7_RGBA,   // VK_FORMAT_BC7_UNORM_BLOCK
+};
+
+struct CompressedTexture {
+    CompressedFormat format = CompressedFormat::ETC2_RGBA8;
+    int width = 0;
+    int height = 0;
+    bool premultiplied = false; // from the KTX2 data format descriptor
+    std::vector<uint8_t> data;  // mip level 0, tightly packed blocks
+
+    /// what the same image costs as uncompressed RGBA8
+    size_t rgbaBytes() const { return (size_t)width * height * 4; }
+};
+
+/// file name suffix an offline-encoded variant of an asset uses, e.g. "knob.bc7.ktx2"
+const char* compressedSuffix(CompressedFormat format);
+
+/// size of one mip level in bytes; both formats use 16-byte 4x4 blocks
+size_t compressedLevelSize(int width, int height);
+
+/// reads level 0 of a KTX2 file; false (with a printed reason) if the file is
+/// missing, malformed, supercompressed, or not one of the formats above
+bool loadKTX2(const char* filename, CompressedTexture& out);
@@ -0,0 +1,47 @@
+#include "decimate.h"
+#include "simd.h"
+
+void minMaxScalar(const float* p, size_t n, float& mn, float& mx) {
+    for (size_t i = 0; i < n; ++i) {
+        if (p[i] < mn) mn = p[i];
+        if (p[i] > mx) mx = p[i];
+    }
+}
+
+// 8 samples per iteration in two independent accumulator pairs, so the
+// min/max latency chains overlap; lanes are folded once at the end
+void minMax(const float* p, size_t n, float& mn, float& mx) {
+    size_t i = 0;
+    if (n >= 8) {
+        simd::f32x4 lo0 = simd::splat(mn), lo1 = lo0;
+        simd::f32x4 hi0 = simd::splat(mx), hi1 = hi0;
+        for (; i + 8 <= n; i += 8) {
+            simd::f32x4 a = simd::load(p + i), b = simd::load(p + i + 4);
+            lo0 = simd::min(lo0, a); hi0 = simd::max(hi0, a);
+            lo1 = simd::min(lo1, b); hi1 = simd::max(hi1, b);
+        }
+        float lo[4], hi[4];
+        simd::store(lo, simd::min(lo0, lo1));
+        simd::store(hi, simd::max(hi0, hi1));
+        for (int k = 0; k < 4; ++k) {
+            if (lo[k] < mn) mn = lo[k];
+            if (hi[k] > mx) mx = hi[k];
+        }
+    }
+    minMaxScalar(p + i, n - i, mn, mx);
+}
+
+void minMaxColumns(const float* a, size_t na, const float* b, size_t nb,
+                   float* mins, float* maxs, size_t columns) {
+    const size_t total = na + nb;
+    for (size_t c = 0; c < columns; ++c) {
+        const size_t begin = total * c / columns, end = total * (c + 1) / columns;
+        if (begin == end) { mins[c] = maxs[c] = 0.0f; continue; }
+        float mn = begin < na ? a[begin] : b[begin - na];
+        float mx = mn;
+        if (begin < na) minMax(a + begin, (end < na ? end : na) - begin, mn, mx);
+        if (end > na) minMax(b + (begin > na ? begin - na : 0), end - (begin > na ? begin : na), mn, mx);
+        mins[c] = mn;
+        maxs[c] = mx;
+    }
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+
+// Min/max decimation for waveform and meter displays: thousands of samples
+// per frame collapse into one [min, max] pair per pixel column.  The samples
+// may come as two pieces (a ring buffer that wraps) and are read in place.
+
+/// widen [mn, mx] to cover n samples at p (n may be 0)
+void minMax(const float* p, size_t n, float& mn, float& mx);
+
+/// plain reference version of minMax, same result
+void minMaxScalar(const float* p, size_t n, float& mn, float& mx);
+
+/// the na + nb samples of a then b, split into columns runs of (nearly) equal
+/// length; each run's min and max.  a column with no samples gets 0, 0
+void minMaxColumns(const float* a, size_t na, const float* b, size_t nb,
+                   float* mins, float* maxs, size_t columns);
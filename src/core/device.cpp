@@ -0,0 +1,189 @@
+#include "device.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+std::vector<uint32_t> QueueFamilies::unique() const {
+    std::vector<uint32_t> families;
+    for (uint32_t f : { graphics, present, transfer })
+        if (f != kNoQueueFamily && std::find(families.begin(), families.end(), f) == families.end())
+            families.push_back(f);
+    return families;
+}
+
+QueueFamilies findQueueFamilies(VkPhysicalDevice phys, VkSurfaceKHR surface) {
+    uint32_t count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(phys, &count, nullptr);
+    std::vector<VkQueueFamilyProperties> props(count);
+    vkGetPhysicalDeviceQueueFamilyProperties(phys, &count, props.data());
+
+    QueueFamilies f;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (!props[i].queueCount) continue;
+        VkBool32 presents = VK_FALSE;
+        if (surface != VK_NULL_HANDLE) vkGetPhysicalDeviceSurfaceSupportKHR(phys, i, surface, &presents);
+        const bool graphics = (props[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
+        // one family for both saves a queue ownership transfer of every swapchain image
+        if (graphics && presents) {
+            f.graphics = f.present = i;
+            break;
+        }
+        if (graphics && f.graphics == kNoQueueFamily) f.graphics = i;
+        if (presents && f.present == kNoQueueFamily) f.present = i;
+    }
+    if (f.graphics == kNoQueueFamily) return f;
+
+    // transfer-only families are the copy engines.  texture streaming copies
+    // row slices, so the family must take any offset (granularity 1x1x1)
+    f.transfer = f.graphics;
+    for (uint32_t i = 0; i < count; ++i) {
+        const VkQueueFlags flags = props[i].queueFlags;
+        const VkExtent3D g = props[i].minImageTransferGranularity;
+        if (props[i].queueCount && (flags & VK_QUEUE_TRANSFER_BIT) &&
+            !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) && g.width == 1 && g.height == 1 && g.depth == 1) {
+            f.transfer = i;
+            break;
+        }
+    }
+    return f;
+}
+
+int64_t scoreDevice(const VkPhysicalDeviceProperties& props, const VkPhysicalDeviceFeatures& features,
+                    const VkPhysicalDeviceMemoryProperties& memory, const QueueFamilies& families) {
+    if (!families.usable()) return -1;
+    if (props.limits.maxImageDimension2D < 2048) return -1; // glyph atlas, layer targets
+
+    // the type decides; everything below only orders devices of the same type
+    int64_t score = 0;
+    switch (props.deviceType) {
+    case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:   score = 40000; break;
+    case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: score = 30000; break;
+    case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:    score = 20000; break;
+    case VK_PHYSICAL_DEVICE_TYPE_OTHER:          score = 10000; break;
+    default:                                     score = 0; break; // CPU
+    }
+    // compressed art stays a quarter of its RGBA size in memory
+    if (features.textureCompressionBC) score += 1000;
+    if (features.textureCompressionETC2) score += 1000;
+    if (features.samplerAnisotropy) score += 200;
+    if (families.dedicatedTransfer()) score += 200;
+
+    VkDeviceSize local = 0;
+    for (uint32_t i = 0; i < memory.memoryHeapCount; ++i)
+        if (memory.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) local += memory.memoryHeaps[i].size;
+    score += std::min<int64_t>((int64_t)(local >> 28), 2000); // a point per 256 MiB
+    return score;
+}
+
+static bool hasExtension(const std::vector<VkExtensionProperties>& exts, const char* name) {
+    for (const VkExtensionProperties& e : exts)
+        if (strcmp(e.extensionName, name) == 0) return true;
+    return false;
+}
+
+static std::vector<VkExtensionProperties> deviceExtensions(VkPhysicalDevice phys) {
+    uint32_t count = 0;
+    vkEnumerateDeviceExtensionProperties(phys, nullptr, &count, nullptr);
+    std::vector<VkExtensionProperties> exts(count);
+    vkEnumerateDeviceExtensionProperties(phys, nullptr, &count, exts.data());
+    return exts;
+}
+
+static const char* typeName(VkPhysicalDeviceType type) {
+    switch (type) {
+    case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:   return "discrete";
+    case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: return "integrated";
+    case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:    return "virtual";
+    case VK_PHYSICAL_DEVICE_TYPE_CPU:            return "cpu";
+    default:                                     return "other";
+    }
+}
+
+// SUBA_VK_DEVICE: all digits is an index, anything else part of the name
+static bool matchesOverride(const char* want, uint32_t index, const char* name) {
+    const std::string w(want);
+    if (std::all_of(w.begin(), w.end(), [](char c) { return std::isdigit((unsigned char)c) != 0; }))
+        return (uint32_t)atoi(want) == index;
+    std::string lowerName(name), lowerWant(w);
+    for (char& c : lowerName) c = (char)std::tolower((unsigned char)c);
+    for (char& c : lowerWant) c = (char)std::tolower((unsigned char)c);
+    return lowerName.find(lowerWant) != std::string::npos;
+}
+
+DeviceChoice pickPhysicalDevice(VkInstance instance, VkSurfaceKHR surface) {
+    uint32_t count = 0;
+    vkEnumeratePhysicalDevices(instance, &count, nullptr);
+    std::vector<VkPhysicalDevice> gpus(count);
+    vkEnumeratePhysicalDevices(instance, &count, gpus.data());
+
+    const char* want = getenv("SUBA_VK_DEVICE");
+    if (want && !*want) want = nullptr;
+    DeviceChoice best, wanted;
+    int64_t bestScore = -1;
+    for (uint32_t i = 0; i < count; ++i) {
+        VkPhysicalDeviceProperties props;
+        VkPhysicalDeviceFeatures features;
+        VkPhysicalDeviceMemoryProperties memory;
+        vkGetPhysicalDeviceProperties(gpus[i], &props);
+        vkGetPhysicalDeviceFeatures(gpus[i], &features);
+        vkGetPhysicalDeviceMemoryProperties(gpus[i], &memory);
+        const std::vector<VkExtensionProperties> exts = deviceExtensions(gpus[i]);
+
+        DeviceChoice c;
+        c.phys = gpus[i];
+        c.families = findQueueFamilies(gpus[i], surface);
+        c.portabilitySubset = hasExtension(exts, "VK_KHR_portability_subset");
+        const int64_t score = hasExtension(exts, VK_KHR_SWAPCHAIN_EXTENSION_NAME)
+                                  ? scoreDevice(props, features, memory, c.families) : -1;
+        if (score < 0)
+            printf("Vulkan device %u: %s (%s) can't draw to this window\n", i, props.deviceName, typeName(props.deviceType));
+        else
+            printf("Vulkan device %u: %s (%s), score %lld, queue families graphics %u present %u transfer %u\n",
+                   i, props.deviceName, typeName(props.deviceType), (long long)score,
+                   c.families.graphics, c.families.present, c.families.transfer);
+        if (score < 0) continue;
+        if (want && wanted.phys == VK_NULL_HANDLE && matchesOverride(want, i, props.deviceName)) wanted = c;
+        if (score > bestScore) {
+            bestScore = score;
+            best = c;
+        }
+    }
+
+    if (want) {
+        if (wanted.phys != VK_NULL_HANDLE) {
+            printf("SUBA_VK_DEVICE=%s overrides the choice\n", want);
+            return wanted;
+        }
+        printf("WARNING: SUBA_VK_DEVICE=%s matches no usable device; picking by score\n", want);
+    }
+    return best;
+}
+
+std::vector<const char*> instanceExtensions(VkInstanceCreateFlags& flags) {
+    uint32_t count = 0;
+    vkEnumerateInstanceExtensionProperties(nullptr, &count, nullptr);
+    std::vector<VkExtensionProperties> available(count);
+    vkEnumerateInstanceExtensionProperties(nullptr, &count, available.data());
+
+    std::vector<const char*> exts = { VK_KHR_SURFACE_EXTENSION_NAME };
+#if defined(__APPLE__)
+    exts.push_back("VK_MVK_macos_surface");
+#elif defined(_WIN32)
+    exts.push_back("VK_KHR_win32_surface");
+#else
+    exts.push_back("VK_KHR_xlib_surface"); // PlatformWindow_x11
+#endif
+    for (const char* e : exts)
+        if (!hasExtension(available, e)) printf("WARNING: the Vulkan loader has no %s; windows can't be drawn to\n", e);
+
+    // MoltenVK only shows up to loaders that are asked for portability devices
+    flags = 0;
+    if (hasExtension(available, VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME)) {
+        exts.push_back(VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME);
+        flags |= VK_INSTANCE_CREATE_ENUMERATE_PORTABILITY_BIT_KHR;
+    }
+    return exts;
+}
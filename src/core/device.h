@@ -0,0 +1,49 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+
+// Which GPU and which queues the Vulkan backend uses.
+//
+// Every physical device that can draw and present to the window's surface is
+// scored: discrete over integrated over virtual over CPU (lavapipe and
+// friends are a last resort), then features the renderer can use
+// (compressed texture formats, anisotropy), then device-local memory.
+// SUBA_VK_DEVICE overrides the choice with an index into the enumeration or
+// a case-insensitive part of the device name ("1", "nvidia", "llvmpipe");
+// the choices and scores are printed, so the right value is easy to find.
+
+constexpr uint32_t kNoQueueFamily = UINT32_MAX;
+
+struct QueueFamilies {
+    uint32_t graphics = kNoQueueFamily;
+    uint32_t present = kNoQueueFamily;  // same as graphics whenever one family can do both
+    uint32_t transfer = kNoQueueFamily; // a DMA-only family if there is one, else graphics
+
+    bool usable() const { return graphics != kNoQueueFamily && present != kNoQueueFamily; }
+    /// uploads can run beside drawing instead of in the graphics queue
+    bool dedicatedTransfer() const { return transfer != graphics; }
+    /// the distinct families, for VkDeviceQueueCreateInfo and concurrent sharing
+    std::vector<uint32_t> unique() const;
+};
+
+struct DeviceChoice {
+    VkPhysicalDevice phys = VK_NULL_HANDLE;
+    QueueFamilies families;
+    bool portabilitySubset = false; // must be enabled when offered (MoltenVK)
+};
+
+/// graphics, present and transfer families of phys for surface
+QueueFamilies findQueueFamilies(VkPhysicalDevice phys, VkSurfaceKHR surface);
+
+/// higher is better; < 0 if the device can't be used at all
+int64_t scoreDevice(const VkPhysicalDeviceProperties& props, const VkPhysicalDeviceFeatures& features,
+                    const VkPhysicalDeviceMemoryProperties& memory, const QueueFamilies& families);
+
+/// the best device for surface (or the SUBA_VK_DEVICE one); phys is
+/// VK_NULL_HANDLE if no device can draw to it
+DeviceChoice pickPhysicalDevice(VkInstance instance, VkSurfaceKHR surface);
+
+/// instance extensions for this platform's window surfaces, plus portability
+/// enumeration where the loader offers it; sets flags to match
+std::vector<const char*> instanceExtensions(VkInstanceCreateFlags& flags);
@@ -0,0 +1,63 @@
+#include "frame_arena.h"
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+FrameArena::FrameArena(size_t initialBytes)
+    : main(new unsigned char[initialBytes]), mainSize(initialBytes) {}
+
+void* FrameArena::allocate(size_t bytes, size_t align) {
+    size_t aligned = (offset + align - 1) & ~(align - 1);
+    usedBytes += bytes + (aligned - offset);
+    if (aligned + bytes <= mainSize) {
+        offset = aligned + bytes;
+        return main.get() + aligned;
+    }
+    // doesn't fit this frame: hand out a dedicated block, reset() folds it into main
+    overflow.emplace_back(new unsigned char[bytes + align]);
+    uintptr_t p = reinterpret_cast<uintptr_t>(overflow.back().get());
+    return reinterpret_cast<void*>((p + align - 1) & ~(uintptr_t)(align - 1));
+}
+
+void FrameArena::reset() {
+    if (usedBytes > peakBytes) peakBytes = usedBytes;
+    if (!overflow.empty()) {
+        overflow.clear();
+        mainSize = peakBytes + peakBytes / 2;
+        main.reset(new unsigned char[mainSize]);
+    }
+    offset = 0;
+    usedBytes = 0;
+}
+
+void FrameAllocCheck::endFrame() {
+    if (!alloc_counter::enabled()) return;
+    uint64_t now = alloc_counter::threadAllocations();
+    uint64_t delta = now - lastCount;
+    lastCount = now;
+    if (++frame <= kWarmupFrames || delta == 0) return;
+    printf("WARNING: %llu heap allocations during frame %d\n", (unsigned long long)delta, frame);
+#ifdef SUBA_ASSERT_FRAME_ALLOCS
+    assert(delta == 0 && "general-heap allocation in a steady-state frame");
+#endif
+}
+
+#ifdef SUBA_TRACK_ALLOCS
+static thread_local uint64_t tAllocations = 0;
+
+uint64_t alloc_counter::threadAllocations() { return tAllocations; }
+
+void* operator new(size_t n) {
+    ++tAllocations;
+    if (void* p = malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t n) { return operator new(n); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+#else
+uint64_t alloc_counter::threadAllocations() { return 0; }
+#endif
@@ -0,0 +1,91 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Per-frame bump allocator.  Everything that only lives until the end of the
+// current frame (queued quads, staging vertices, text/batching scratch) is
+// carved out of one block and released in O(1) by reset() when the frame is
+// presented.  If a frame overflows the block, the overflow goes to extra
+// blocks and the next reset() grows the main block to fit, so a steady-state
+// frame never touches the general heap.
+
+class FrameArena {
+public:
+    explicit FrameArena(size_t initialBytes = 256 * 1024);
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* allocate(size_t bytes, size_t align = alignof(std::max_align_t));
+
+    /// release everything allocated since the last reset
+    void reset();
+
+    size_t used() const { return usedBytes; }
+    size_t capacity() const { return mainSize; }
+    size_t highWater() const { return peakBytes; }
+
+private:
+    std::unique_ptr<unsigned char[]> main;
+    size_t mainSize = 0;
+    size_t offset = 0;
+    size_t usedBytes = 0;
+    size_t peakBytes = 0;
+    std::vector<std::unique_ptr<unsigned char[]>> overflow; // only non-empty in a frame that outgrew main
+};
+
+/// std allocator over a FrameArena; deallocate is a no-op, reset() frees
+template <typename T>
+struct ArenaAllocator {
+    using value_type = T;
+
+    FrameArena* arena = nullptr;
+
+    ArenaAllocator() = default;
+    explicit ArenaAllocator(FrameArena* a) : arena(a) {}
+    template <typename U> ArenaAllocator(const ArenaAllocator<U>& o) : arena(o.arena) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) {}
+
+    template <typename U> bool operator==(const ArenaAllocator<U>& o) const { return arena == o.arena; }
+    template <typename U> bool operator!=(const ArenaAllocator<U>& o) const { return arena != o.arena; }
+};
+
+/// vector whose storage lives until the arena is reset. re-create it after reset()
+template <typename T>
+using FrameVector = std::vector<T, ArenaAllocator<T>>;
+
+template <typename T>
+FrameVector<T> makeFrameVector(FrameArena& arena, size_t reserve = 0) {
+    FrameVector<T> v{ ArenaAllocator<T>(&arena) };
+    if (reserve) v.reserve(reserve);
+    return v;
+}
+
+// Debug allocation counter.  Built with SUBA_TRACK_ALLOCS, the global
+// operator new is replaced by a counting one (per thread), and the renderer
+// checks the count between presented frames; with SUBA_ASSERT_FRAME_ALLOCS a
+// steady-state frame that hits malloc trips an assert.
+namespace alloc_counter {
+    /// heap allocations made by the calling thread so far (0 if tracking is compiled out)
+    uint64_t threadAllocations();
+    constexpr bool enabled() {
+#ifdef SUBA_TRACK_ALLOCS
+        return true;
+#else
+        return false;
+#endif
+    }
+}
+
+/// per-renderer bookkeeping for the "no malloc in a steady frame" rule
+struct FrameAllocCheck {
+    static constexpr int kWarmupFrames = 120; // first frames may still be growing caches
+    int frame = 0;
+    uint64_t lastCount = 0;
+
+    /// call once per presented frame, on the thread that builds and draws frames
+    void endFrame();
+};
@@ -0,0 +1,38 @@
+#include "mip_chain.h"
+
+static void downsample(const uint8_t* src, int sw, int sh, uint8_t* dst, int dw, int dh) {
+    for (int y = 0; y < dh; ++y) {
+        const uint8_t* r0 = src + (size_t)(2 * y) * sw * 4;
+        const uint8_t* r1 = src + (size_t)(2 * y + 1 < sh ? 2 * y + 1 : sh - 1) * sw * 4;
+        for (int x = 0; x < dw; ++x) {
+            int x0 = 2 * x * 4;
+            int x1 = (2 * x + 1 < sw ? 2 * x + 1 : sw - 1) * 4;
+            for (int c = 0; c < 4; ++c)
+                *dst++ = (uint8_t)((r0[x0 + c] + r0[x1 + c] + r1[x0 + c] + r1[x1 + c] + 2) >> 2);
+        }
+    }
+}
+
+void buildMipChain(const Texture& base, MipChain& out) {
+    out.levels.clear();
+    out.levels.push_back(base);
+
+    // size everything up front so level pointers into storage stay valid
+    size_t total = 0;
+    for (int w = base.width, h = base.height; w > 1 || h > 1;) {
+        w = w > 1 ? w / 2 : 1;
+        h = h > 1 ? h / 2 : 1;
+        total += (size_t)w * h * 4;
+    }
+    out.storage.resize(total);
+
+    uint8_t* dst = out.storage.data();
+    while (out.levels.back().width > 1 || out.levels.back().height > 1) {
+        const Texture& src = out.levels.back();
+        int w = src.width > 1 ? src.width / 2 : 1;
+        int h = src.height > 1 ? src.height / 2 : 1;
+        downsample(reinterpret_cast<const uint8_t*>(src.data), src.width, src.height, dst, w, h);
+        out.levels.push_back(Texture(w, h, reinterpret_cast<char*>(dst)));
+        dst += (size_t)w * h * 4;
+    }
+}
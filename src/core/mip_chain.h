@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "renderer.h"
+
+// Mip levels for a texture, built on the CPU at load time so it can run on a
+// worker thread (GLES2's glGenerateMipmap would need the GL thread).  Input
+// is already premultiplied, so a plain 2x2 box average is the correct filter
+// and edges don't pick up dark fringes from transparent neighbours.
+
+struct MipChain {
+    std::vector<Texture> levels;  // levels[0] aliases the source pixels
+    std::vector<uint8_t> storage; // every level after the first
+
+    // levels point into storage: moving keeps the buffer, copying wouldn't
+    MipChain() = default;
+    MipChain(MipChain&&) = default;
+    MipChain& operator=(MipChain&&) = default;
+    MipChain(const MipChain&) = delete;
+    MipChain& operator=(const MipChain&) = delete;
+};
+
+/// halve down to 1x1; odd sizes round down and reuse the last row/column
+void buildMipChain(const Texture& base, MipChain& out);
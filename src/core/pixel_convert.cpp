@@ -0,0 +1,98 @@
+#include "pixel_convert.h"
+#include "simd.h"
+
+void convertPixelsScalar(uint8_t* p, size_t n, PixelFormat dst, bool premultiply) {
+    const bool swap = dst == PixelFormat::BGRA8;
+    for (size_t i = 0; i < n; ++i, p += 4) {
+        uint8_t r = p[0], g = p[1], b = p[2], a = p[3];
+        if (premultiply) {
+            r = mulDiv255(r, a);
+            g = mulDiv255(g, a);
+            b = mulDiv255(b, a);
+        }
+        p[0] = swap ? b : r;
+        p[1] = g;
+        p[2] = swap ? r : b;
+        p[3] = a;
+    }
+}
+
+#if SUBA_SIMD_SSE2
+
+// 4 pixels per iteration. SSE2 has no byte shuffle, so channels are moved
+// with 32-bit shifts and masks, and the multiply is done in 16-bit lanes.
+static inline __m128i premultiply4(__m128i px) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi16(128);
+    const __m128i alphaMask = _mm_set1_epi32((int)0xFF000000);
+
+    // broadcast each pixel's alpha to its 4 bytes, then keep alpha itself as 255
+    __m128i a = _mm_srli_epi32(px, 24);
+    a = _mm_or_si128(a, _mm_slli_epi32(a, 8));
+    a = _mm_or_si128(a, _mm_slli_epi32(a, 16));
+    a = _mm_or_si128(a, alphaMask);
+
+    __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(px, zero), _mm_unpacklo_epi8(a, zero));
+    __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(px, zero), _mm_unpackhi_epi8(a, zero));
+    lo = _mm_add_epi16(lo, bias);
+    hi = _mm_add_epi16(hi, bias);
+    lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+    hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+    return _mm_packus_epi16(lo, hi);
+}
+
+static inline __m128i swapRB4(__m128i px) {
+    const __m128i ga = _mm_set1_epi32((int)0xFF00FF00);
+    const __m128i lowByte = _mm_set1_epi32(0xFF);
+    __m128i r = _mm_and_si128(px, lowByte);
+    __m128i b = _mm_and_si128(_mm_srli_epi32(px, 16), lowByte);
+    return _mm_or_si128(_mm_and_si128(px, ga), _mm_or_si128(_mm_slli_epi32(r, 16), b));
+}
+
+void convertPixels(uint8_t* p, size_t n, PixelFormat dst, bool premultiply) {
+    const bool swap = dst == PixelFormat::BGRA8;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i * 4));
+        if (premultiply) px = premultiply4(px);
+        if (swap) px = swapRB4(px);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p + i * 4), px);
+    }
+    convertPixelsScalar(p + i * 4, n - i, dst, premultiply);
+}
+
+#elif SUBA_SIMD_NEON
+
+// 8 pixels per iteration, deinterleaved into planes by vld4
+static inline uint8x8_t premul8(uint8x8_t c, uint8x8_t a) {
+    uint16x8_t t = vaddq_u16(vmull_u8(c, a), vdupq_n_u16(128));
+    return vaddhn_u16(t, vshrq_n_u16(t, 8));
+}
+
+void convertPixels(uint8_t* p, size_t n, PixelFormat dst, bool premultiply) {
+    const bool swap = dst == PixelFormat::BGRA8;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint8x8x4_t px = vld4_u8(p + i * 4);
+        if (premultiply) {
+            px.val[0] = premul8(px.val[0], px.val[3]);
+            px.val[1] = premul8(px.val[1], px.val[3]);
+            px.val[2] = premul8(px.val[2], px.val[3]);
+        }
+        if (swap) {
+            uint8x8_t r = px.val[0];
+            px.val[0] = px.val[2];
+            px.val[2] = r;
+        }
+        vst4_u8(p + i * 4, px);
+    }
+    convertPixelsScalar(p + i * 4, n - i, dst, premultiply);
+}
+
+#else
+
+void convertPixels(uint8_t* p, size_t n, PixelFormat dst, bool premultiply) {
+    convertPixelsScalar(p, n, dst, premultiply);
+}
+
+#endif
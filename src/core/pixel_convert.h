@@ -0,0 +1,24 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Image import conversion: decoders hand us straight-alpha RGBA8, the GPU
+// wants the backend's native channel order with premultiplied alpha so that
+// blending is a single ONE, ONE_MINUS_SRC_ALPHA and sampling never swizzles.
+
+enum class PixelFormat {
+    RGBA8, // GL
+    BGRA8, // Vulkan swapchain / most desktop GPUs
+};
+
+/// in place: straight RGBA8 -> dst channel order, optionally premultiplied
+void convertPixels(uint8_t* pixels, size_t pixelCount, PixelFormat dst, bool premultiply);
+
+/// plain reference version of convertPixels, bit-identical output
+void convertPixelsScalar(uint8_t* pixels, size_t pixelCount, PixelFormat dst, bool premultiply);
+
+/// c * a / 255, correctly rounded; the SIMD kernels use the same formula
+inline uint8_t mulDiv255(unsigned c, unsigned a) {
+    unsigned t = c * a + 128;
+    return (uint8_t)((t + (t >> 8)) >> 8);
+}
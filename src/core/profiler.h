@@ -0,0 +1,99 @@
+#pragma once
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+// Frame timing for comparing render modes (caller thread vs render thread)
+// and present policies.  Each Stat is written by exactly one thread and
+// prints its own summary, so nothing here needs locking.  Times are in
+// nanoseconds from steady_clock.
+
+namespace profiler {
+
+inline uint64_t nowNs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// running count / mean / max / stddev of one measurement, reset after each report
+struct Stat {
+    const char* name;
+    uint64_t count = 0;
+    double sum = 0.0, sumSq = 0.0, max = 0.0;
+
+    explicit Stat(const char* n) : name(n) {}
+
+    void add(uint64_t ns) {
+        double ms = ns * 1e-6;
+        ++count;
+        sum += ms;
+        sumSq += ms * ms;
+        if (ms > max) max = ms;
+    }
+    double mean() const { return count ? sum / count : 0.0; }
+    double stddev() const {
+        if (count < 2) return 0.0;
+        double m = mean(), var = sumSq / count - m * m;
+        return var > 0.0 ? std::sqrt(var) : 0.0;
+    }
+    void print(const char* mode) const {
+        printf("[profile %s] %-16s avg %6.3f ms  max %6.3f ms  sd %6.3f ms  (%llu)\n",
+               mode, name, mean(), max, stddev(), (unsigned long long)count);
+    }
+    void reset() { count = 0; sum = sumSq = max = 0.0; }
+};
+
+/// what the host thread pays per frame: time inside Renderer::drawFrame()
+struct CallerStats {
+    Stat blocked{ "caller blocked" };
+    uint64_t callStart = 0;
+
+    void begin() { callStart = nowNs(); }
+    void end(const char* mode, uint64_t reportEvery) {
+        blocked.add(nowNs() - callStart);
+        if (blocked.count >= reportEvery) { blocked.print(mode); blocked.reset(); }
+    }
+};
+
+/// what the viewer sees: submit -> present and input -> present latency, and
+/// present-to-present jitter.  presentNs is taken right after the swap returns
+struct PresentStats {
+    Stat latency{ "submit->present" };
+    Stat input{ "input->present" };   // only frames that answer an input event
+    Stat interval{ "present interval" }; // its stddev is the jitter
+    uint64_t lastPresent = 0;
+
+    void presented(uint64_t presentNs, uint64_t submitNs, uint64_t inputNs, const char* mode, uint64_t reportEvery) {
+        latency.add(presentNs - submitNs);
+        if (inputNs) input.add(presentNs - inputNs);
+        if (lastPresent) interval.add(presentNs - lastPresent);
+        lastPresent = presentNs;
+        if (latency.count >= reportEvery) {
+            latency.print(mode);
+            if (input.count) input.print(mode);
+            interval.print(mode);
+            latency.reset();
+            input.reset();
+            interval.reset();
+        }
+    }
+};
+
+/// holds an unsynchronized present (mailbox / swap interval 0) to the display's
+/// rate: sleeps after the swap rather than before, so the next frame starts
+/// right away and samples the freshest input, and frames never queue in the driver
+struct FramePacer {
+    uint64_t periodNs = 1000000000ull / 60;
+    uint64_t nextNs = 0;
+
+    void setRefreshRate(float hz) { periodNs = (uint64_t)(1e9 / (hz > 1.0f ? hz : 60.0f)); }
+    void afterPresent(uint64_t presentNs) {
+        if (nextNs > presentNs) std::this_thread::sleep_for(std::chrono::nanoseconds(nextNs - presentNs));
+        // a frame that ran late starts a new cadence instead of bursting to catch up
+        nextNs = (nextNs > presentNs ? nextNs : presentNs) + periodNs;
+    }
+};
+
+} // namespace profiler
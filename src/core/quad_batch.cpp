@@ -0,0 +1,43 @@
+#include "quad_batch.h"
+#include "simd.h"
+
+void expandQuadsScalar(const Quad* quads, size_t n, QuadVertex* out) {
+    for (size_t i = 0; i < n; ++i) {
+        const Quad& q = quads[i];
+        for (int k = 0; k < 4; ++k)
+            out[i * 4 + k] = { q.verts[k*2 + 0], q.verts[k*2 + 1], q.uvs[k*2 + 0], q.uvs[k*2 + 1], q.colors[k] };
+    }
+}
+
+void expandQuads(const Quad* quads, size_t n, QuadVertex* out) {
+    for (size_t i = 0; i < n; ++i, out += 4) {
+        const Quad& q = quads[i];
+        // two corners per register: { x0 y0 x1 y1 } { x2 y2 x3 y3 }, same for uv
+        simd::f32x4 p01 = simd::load(q.verts.data());
+        simd::f32x4 p23 = simd::load(q.verts.data() + 4);
+        simd::f32x4 t01 = simd::load(q.uvs.data());
+        simd::f32x4 t23 = simd::load(q.uvs.data() + 4);
+
+        // { x y u v } per corner, color after each one
+        simd::store(&out[0].x, simd::lowHalves(p01, t01));
+        simd::store(&out[1].x, simd::highHalves(p01, t01));
+        simd::store(&out[2].x, simd::lowHalves(p23, t23));
+        simd::store(&out[3].x, simd::highHalves(p23, t23));
+        out[0].color = q.colors[0];
+        out[1].color = q.colors[1];
+        out[2].color = q.colors[2];
+        out[3].color = q.colors[3];
+    }
+}
+
+void fillQuadIndices(uint16_t* out, size_t quadCount) {
+    for (size_t i = 0; i < quadCount; ++i) {
+        const uint16_t base = (uint16_t)(i * 4);
+        out[i*6 + 0] = base + 0;
+        out[i*6 + 1] = base + 1;
+        out[i*6 + 2] = base + 2;
+        out[i*6 + 3] = base + 1;
+        out[i*6 + 4] = base + 3;
+        out[i*6 + 5] = base + 2;
+    }
+}
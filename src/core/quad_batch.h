@@ -1,10 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "renderer.h"
 
-struct QuadVertex { float x,y; float u,v; uint32_t colorABGR; };
+// Quad -> GPU vertex expansion shared by the backends.
+//
+// Each Quad becomes 4 interleaved vertices (tl, tr, bl, br); the backends draw
+// them with a static index buffer of two triangles per quad, so the per-frame
+// upload is 80 bytes per quad and the index data never changes.
 
-struct Quad { float x,y,w,h; float u0,v0,u1,v1; uint32_t color; VkImageView tex; };
-class QuadBatch {
-  void begin();
-  void add(const Quad& q);
-  void flush(Renderer& r); // records draw calls, texture binds grouped
+struct QuadVertex {
+    float x, y;
+    float u, v;
+    uint32_t color; // ABGR bytes, read as normalized RGBA
 };
+static_assert(sizeof(QuadVertex) == 20, "QuadVertex must stay tightly packed");
 
+constexpr size_t kVertsPerQuad = 4;
+constexpr size_t kIndicesPerQuad = 6;
+// 16-bit indices address 65536 vertices
+constexpr size_t kMaxQuadsPerIndexedDraw = 65536 / kVertsPerQuad;
+
+/// interleave quads[0..n) into out[0..4n); out may be mapped GPU memory (write-only access)
+void expandQuads(const Quad* quads, size_t n, QuadVertex* out);
+
+/// plain reference version of expandQuads, bit-identical output
+void expandQuadsScalar(const Quad* quads, size_t n, QuadVertex* out);
+
+/// fill the shared index pattern 0,1,2, 1,3,2 for quadCount quads
+void fillQuadIndices(uint16_t* out, size_t quadCount);
@@ -0,0 +1,81 @@
+#include "render_thread.h"
+
+RenderThread& RenderThread::instance() {
+    static RenderThread* rt = new RenderThread(); // never freed, see the header
+    static struct Join { ~Join() { rt->shutdown(); } } join;
+    return *rt;
+}
+
+RenderThread::RenderThread() {
+    thread = std::thread([this]() { loop(); });
+}
+
+RenderThread::~RenderThread() {
+    shutdown();
+}
+
+void RenderThread::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stop) return;
+        stop = true;
+    }
+    cv.notify_one();
+    thread.join();
+}
+
+void RenderThread::post(std::function<void()> fn) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!stopped) {
+            tasks.push_back(std::move(fn));
+            cv.notify_one();
+            return;
+        }
+    }
+    fn(); // the thread is gone, so no other thread makes GL calls any more
+}
+
+void RenderThread::wake() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        framesPending = true;
+    }
+    cv.notify_one();
+}
+
+void RenderThread::addClient(void* key, std::function<void()> draw) {
+    call([this, key, &draw]() { clients.push_back({ key, std::move(draw) }); });
+}
+
+void RenderThread::removeClient(void* key) {
+    call([this, key]() {
+        for (size_t i = 0; i < clients.size(); ++i)
+            if (clients[i].key == key) { clients.erase(clients.begin() + i); return; }
+    });
+}
+
+void RenderThread::loop() {
+    std::vector<std::function<void()>> run; // swapped with tasks, keeps its capacity
+    bool exiting = false;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this]() { return stop || !tasks.empty() || framesPending; });
+            // queued work still runs: a caller may be blocked in call() on it
+            if (stop && tasks.empty()) {
+                stopped = true;
+                return;
+            }
+            exiting = stop;
+            run.swap(tasks);
+            framesPending = false;
+        }
+        for (auto& fn : run) fn();
+        run.clear();
+
+        // each client presents only if its UI thread published since last time
+        if (!exiting)
+            for (auto& c : clients) c.draw();
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Optional render thread.  In RenderMode::RenderThread the host's UI thread
+// only records each frame into a TripleBuffer and returns; one process-wide
+// RenderThread owns every such Renderer's GL context, draws the newest
+// published frame and blocks on vsync instead of the host.  GPU resource
+// calls (texture creation etc.) made from the UI thread are forwarded here.
+
+/// latest-value handoff between one producer and one consumer; neither side
+/// ever waits, the producer just overwrites a frame the consumer never took
+template <typename T>
+class TripleBuffer {
+public:
+    /// producer: the slot to fill for the next publish()
+    T& writeBuffer() { return slots[back]; }
+    void publish() { back = middle.exchange(back | kFresh, std::memory_order_acq_rel) & kIndex; }
+
+    /// consumer: true if a frame newer than readBuffer() was published
+    bool fetch() {
+        if (!(middle.load(std::memory_order_acquire) & kFresh)) return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & kIndex;
+        return true;
+    }
+    T& readBuffer() { return slots[front]; }
+
+private:
+    static constexpr uint8_t kIndex = 3;
+    static constexpr uint8_t kFresh = 4;
+    T slots[3];
+    uint8_t back = 0;
+    std::atomic<uint8_t> middle{ 1 };
+    uint8_t front = 2;
+};
+
+class RenderThread {
+public:
+    /// started on first use, joined at exit; the object itself stays, so a
+    /// Renderer destroyed after that (a global, a plugin static) still works
+    static RenderThread& instance();
+
+    ~RenderThread();
+
+    /// run what's queued, then join; from then on post() and call() run inline
+    void shutdown();
+
+    bool onThread() const { return std::this_thread::get_id() == thread.get_id(); }
+
+    /// run fn on the render thread; returns immediately (inline once shut down)
+    void post(std::function<void()> fn);
+
+    /// run fn on the render thread and wait for its result (inline if already there)
+    template <typename F>
+    auto call(F fn) -> decltype(fn()) {
+        if (onThread()) return fn();
+        std::packaged_task<decltype(fn())()> task(std::move(fn));
+        auto result = task.get_future();
+        post([&task]() { task(); });
+        return result.get();
+    }
+
+    /// a client draws whatever its TripleBuffer has new each time the thread wakes
+    void addClient(void* key, std::function<void()> draw);
+    void removeClient(void* key);
+
+    /// a client published a frame
+    void wake();
+
+private:
+    RenderThread();
+    void loop();
+
+    struct Client { void* key; std::function<void()> draw; };
+    std::vector<Client> clients; // render thread only
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<std::function<void()>> tasks;
+    bool framesPending = false;
+    bool stop = false;    // shutdown() asked
+    bool stopped = false; // loop() has returned: nothing more is queued
+    std::thread thread;
+};
@@ -4,33 +4,105 @@
 #else
 #include <GLES2/gl2.h>    // Everywhere else
 #endif
+#include <algorithm>
 #include <vector>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstddef>
+#include <cstring>
 #include <stdexcept>
 #include <iostream>
+#include <atomic>
 #include "NativeParent_gl.h"
+#include "quad_batch.h"
+#include "frame_arena.h"
+#include "render_thread.h"
+#include "profiler.h"
+#include "capture.h"
 
+// compressed formats, not in every header set
+#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+#define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
 
-struct QuadData {
-    Quad quad;
-    GLuint texId;
-};
 
-struct Impl {
-    uint64_t ctx; // gl context
+
+// Everything that can live in a GL share group lives here, once per process:
+// the program, the quad index buffer, driver caps and every texture (plus
+// their streaming state).  Each Renderer only owns its window's context,
+// VAO (not shareable) and vertex stream, so N plugin editors upload a skin
+// once instead of N times.
+//
+// In RenderMode::RenderThread every GL call of the group is made on the
+// RenderThread, so nothing here needs a lock; the Renderer methods forward
+// there (see onGL()).
+struct GLShared {
+    uint64_t id = 0;        // share group identity for caches keyed on it
+    uint64_t shareCtx = 0;  // first context of the group; new ones share with it
+    int renderers = 0;
+    bool threaded = false;  // decided by the first Renderer
 
     GLuint program = 0;
-    GLuint vbo = 0;
-    GLuint vao = 0;
+    GLuint sdfProgram = 0;  // same vertex stage and attribute slots, distance-field fragment stage
+    GLuint ibo = 0;
 
     GLint posLoc = -1;
     GLint uvLoc  = -1;
+    GLint colorLoc = -1;
     GLint samplerLoc = -1;
-    GLint screenSizeLoc = -1;
+    GLint transformLoc = -1;
+    GLint sdfSamplerLoc = -1;
+    GLint sdfTransformLoc = -1;
+
+    bool hasETC2 = false; // GLES3 (Pi) or ES3-compatible desktop
+    bool hasBC7 = false;  // BPTC on desktop
+    bool hasNpotMips = false; // GLES2 core only mipmaps power-of-two sizes
+
+    // textures reserved but not yet complete, and the order their data arrived in
+    struct Streaming {
+        int width = 0, height = 0, levelCount = 1;
+        bool hasData = false;
+        TextureUpload upload;
+        int level = 0, row = 0; // next row to copy
+    };
+    std::unordered_map<GLuint, Streaming> streaming;
+    std::deque<GLuint> uploadQueue;
+    std::atomic<size_t> uploadsPending{ 0 }; // reserved and neither complete nor given up on; read from any thread
+    size_t uploadBudget = 2 * 1024 * 1024;
+    GLuint placeholderTex = 0;
+    GLuint pbo = 0;
+
+    // offscreen color buffers; the texture is shared, framebuffers are per context (Impl::fbos)
+    struct Target {
+        int width, height;   // points
+        int pixelW, pixelH;
+        uint64_t serial;     // tells a reused texture name from the target it used to be
+    };
+    std::unordered_map<GLuint, Target> targets;
+    uint64_t targetSerial = 0;     // last one handed out
+    uint64_t targetsDestroyed = 0; // other contexts compare it to drop their framebuffers
+    std::unordered_set<GLuint> sdfTextures; // drawn with sdfProgram (Renderer::setTextureShader)
+    std::unordered_set<GLuint> textures;    // every live texture and target, freed with the group
+
+    /// the live group, or a new one if no Renderer holds it
+    static std::shared_ptr<GLShared> acquire();
 
-    int screenW = 0;
-    int screenH = 0;
+    void init(); // with the group's first context current
+    void destroy(); // with the group's last context current
+    void stream(GLuint texId, TextureUpload upload);
+    void pumpUploads();
+    void uploadRows(const Texture& level, int levelIndex, int row, int rows);
 
-    std::vector<QuadData> drawList;
+    void queryCaps();
+    int usableLevels(int width, int height, int levelCount) const {
+        auto pow2 = [](int v) { return (v & (v - 1)) == 0; };
+        return hasNpotMips || (pow2(width) && pow2(height)) ? levelCount : 1;
+    }
 
     void checkCompile(GLuint shader, const char* type) {
         GLint status = 0;
@@ -60,6 +132,7 @@ struct Impl {
         glAttachShader(prog, fs);
         glBindAttribLocation(prog, 0, "aPos");
         glBindAttribLocation(prog, 1, "aUV");
+        glBindAttribLocation(prog, 2, "aColor");
         glLinkProgram(prog);
 
         GLint linked = 0;
@@ -77,20 +150,91 @@ struct Impl {
     }
 };
 
+struct Impl {
+    uint64_t ctx; // gl context
+    std::shared_ptr<GLShared> gl;
+
+    GLuint vbo = 0;
+    GLuint vao = 0;
+    size_t vboCapacity = 0; // in quads
+    struct TargetFbo { GLuint fbo; uint64_t serial; };
+    std::unordered_map<GLuint, TargetFbo> fbos; // render target texture -> this context's framebuffer
+    uint64_t seenTargetsDestroyed = 0; // GLShared::targetsDestroyed when fbos was last swept
+
+    struct Viewport {
+        int w = 0; // in points, what the layout uses
+        int h = 0;
+        float scale = 1.0f;
+    };
+    Viewport view; // as the caller last set it
+    bool threaded = false; // RenderMode::RenderThread
+    PresentPolicy policy = PresentPolicy::PowerSaving; // as the caller last set it
+    uint64_t pendingInputNs = 0; // oldest input the next frame answers
+
+    // transient per-frame data; everything below is carved out of this and dropped at present
+    FrameArena arena;
+    FrameAllocCheck allocCheck;
+    size_t lastQuadCount = 0;
+
+    // queued quads for this frame, in draw order
+    FrameVector<Quad> drawQuads{ ArenaAllocator<Quad>(&arena) };
+    FrameVector<GLuint> drawTex{ ArenaAllocator<GLuint>(&arena) };
+
+    // render thread mode: drawFrame() publishes the recorded frame here instead.
+    // the vectors keep their capacity, so a steady frame doesn't allocate
+    struct FrameSnapshot {
+        std::vector<Quad> quads;
+        std::vector<GLuint> tex;
+        Viewport view;
+        uint64_t submitNs = 0; // 0 when not profiling
+        uint64_t inputNs = 0;
+    };
+    TripleBuffer<FrameSnapshot> frames;
+
+    // scratch of whichever thread renders; the caller's arena stays on the caller's thread
+    FrameArena renderArena{ 64 * 1024 };
+    FrameAllocCheck renderAllocCheck;
+    FrameVector<QuadVertex> streamVerts{ ArenaAllocator<QuadVertex>(&renderArena) }; // CPU staging when the buffer can't be mapped
+
+    bool profiling = false;
+    FrameCapture* capture = nullptr; // Renderer::setCapture; caller's thread
+    profiler::CallerStats callerStats;   // caller's thread
+    profiler::PresentStats presentStats; // rendering thread
+
+    // PresentPolicy::LowLatency swaps without vsync; rendering thread
+    bool paced = false;
+    profiler::FramePacer pacer;
+
+    /// run fn where this group's GL calls go, waiting for its result
+    template <typename F>
+    auto onGL(F fn) -> decltype(fn()) {
+        return threaded ? RenderThread::instance().call(std::move(fn)) : fn();
+    }
+
+    void render(const Viewport& vp, const Quad* quads, GLuint* tex, size_t quadCount);
+    void drawBatched(float scaleX, float scaleY, float offsetX, float offsetY, const Quad* quads, GLuint* tex, size_t quadCount);
+    void renderTarget(GLuint target, const Quad* quads, const GLuint* textureIds, size_t quadCount);
+    GLuint framebufferFor(GLuint target);
+    void dropStaleFramebuffers();
+    void drawPublished();
+    void afterPresent(uint64_t submitNs, uint64_t inputNs, const char* mode);
+    void uploadVertices(const Quad* quads, size_t quadCount);
+    void endFrame();
+};
+
 // GLSL ES 2.0 shaders in string literals
 static const char* vertexShaderSrc = R"(#version 100
 attribute vec2 aPos;
 attribute vec2 aUV;
+attribute vec4 aColor;
 varying vec2 vUV;
-uniform vec2 uScreenSize; // width, height
+varying vec4 vColor;
+uniform vec4 uTransform; // points -> NDC: xy scale, zw offset (see Impl::drawBatched)
 
 void main() {
-    // Convert screen pixels to NDC
-    vec2 ndc;
-    ndc.x = aPos.x / uScreenSize.x * 2.0 - 1.0;
-    ndc.y = 1.0 - aPos.y / uScreenSize.y * 2.0; // top-left origin
-    gl_Position = vec4(ndc, 0.0, 1.0);
+    gl_Position = vec4(aPos * uTransform.xy + uTransform.zw, 0.0, 1.0);
     vUV = aUV;
+    vColor = vec4(aColor.rgb * aColor.a, aColor.a); // textures are premultiplied, so is the tint
 }
 )";
 
@@ -98,140 +242,811 @@ void main() {
 static const char* fragmentShaderSrc = R"(#version 100
 precision mediump float;
 varying vec2 vUV;
+varying vec4 vColor;
+uniform sampler2D uTex;
+void main() {
+    gl_FragColor = texture2D(uTex, vUV) * vColor;
+}
+)";
+
+// distance fields (tools/sdfgen): alpha 0.5 is the edge.  fwidth gives how far
+// the distance moves per screen pixel, so the edge ramps over one pixel at any
+// scale; without derivatives the ramp is a fixed slice of the field instead
+static const char* sdfFragmentShaderSrc = R"(#version 100
+#ifdef GL_OES_standard_derivatives
+#extension GL_OES_standard_derivatives : enable
+#endif
+precision mediump float;
+varying vec2 vUV;
+varying vec4 vColor;
 uniform sampler2D uTex;
 void main() {
-    gl_FragColor = texture2D(uTex, vUV);
+    float d = texture2D(uTex, vUV).a;
+#ifdef GL_OES_standard_derivatives
+    float w = max(fwidth(d), 1.0 / 255.0);
+#else
+    float w = 0.06;
+#endif
+    gl_FragColor = vColor * clamp((d - 0.5) / w + 0.5, 0.0, 1.0);
 }
 )";
 
+// expand this frame's quads straight into the stream buffer
+void Impl::uploadVertices(const Quad* quads, size_t quadCount) {
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    const size_t bytes = quadCount * kVertsPerQuad * sizeof(QuadVertex);
+#ifdef __APPLE__
+    // desktop GL: orphan + map, the kernel writes directly into GPU-visible memory
+    if (quadCount > vboCapacity) vboCapacity = quadCount + quadCount / 2;
+    glBufferData(GL_ARRAY_BUFFER, vboCapacity * kVertsPerQuad * sizeof(QuadVertex), nullptr, GL_STREAM_DRAW);
+    void* mapped = glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes,
+                                    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (mapped) {
+        expandQuads(quads, quadCount, static_cast<QuadVertex*>(mapped));
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        return;
+    }
+#endif
+    // GLES2 has no buffer mapping: expand into a reused staging array, one upload per frame
+    streamVerts.resize(quadCount * kVertsPerQuad);
+    expandQuads(quads, quadCount, streamVerts.data());
+    glBufferData(GL_ARRAY_BUFFER, bytes, streamVerts.data(), GL_STREAM_DRAW);
+}
+
+// copy up to uploadBudget bytes of queued texel rows, oldest texture first
+void GLShared::pumpUploads() {
+    size_t budget = uploadBudget;
+    while (!uploadQueue.empty()) {
+        GLuint id = uploadQueue.front();
+        Streaming& st = streaming[id];
+        const Texture& level = st.upload.levels[st.level];
+        const size_t rowBytes = (size_t)level.width * 4;
+        int rows = (int)(budget / rowBytes);
+        if (rows < 1) {
+            if (budget < uploadBudget) return; // out of budget for this frame
+            rows = 1; // a single row wider than the budget still has to go
+        }
+        if (rows > level.height - st.row) rows = level.height - st.row;
+
+        glBindTexture(GL_TEXTURE_2D, id);
+        uploadRows(level, st.level, st.row, rows);
+        budget -= budget < rows * rowBytes ? budget : rows * rowBytes;
+        st.row += rows;
+        if (st.row < level.height) continue;
+
+        st.row = 0;
+        if (++st.level < st.levelCount) continue;
+
+        // complete: quads stop drawing the placeholder from now on
+        uploadQueue.pop_front();
+        streaming.erase(id);
+        --uploadsPending;
+    }
+}
+
+void GLShared::uploadRows(const Texture& level, int levelIndex, int row, int rows) {
+    const char* src = level.data + (size_t)level.width * 4 * row;
+#ifdef __APPLE__
+    // desktop GL: go through a pixel buffer so the copy to VRAM is asynchronous
+    const size_t bytes = (size_t)level.width * 4 * rows;
+    if (!pbo) glGenBuffers(1, &pbo);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+    void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (mapped) {
+        memcpy(mapped, src, bytes);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glTexSubImage2D(GL_TEXTURE_2D, levelIndex, 0, row, level.width, rows, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return;
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+#endif
+    // GLES2 has no pixel buffers: plain sub-image copy of the slice
+    glTexSubImage2D(GL_TEXTURE_2D, levelIndex, 0, row, level.width, rows, GL_RGBA, GL_UNSIGNED_BYTE, src);
+}
+
+// drop this frame's transient data and pre-size next frame's lists from this one
+void Impl::endFrame() {
+    lastQuadCount = drawQuads.size();
+    drawQuads = FrameVector<Quad>(ArenaAllocator<Quad>(&arena));
+    drawTex = FrameVector<GLuint>(ArenaAllocator<GLuint>(&arena));
+    arena.reset();
+    drawQuads.reserve(lastQuadCount);
+    drawTex.reserve(lastQuadCount);
+    allocCheck.endFrame();
+}
+
+std::shared_ptr<GLShared> GLShared::acquire() {
+    static std::weak_ptr<GLShared> current;
+    static uint64_t nextId = 1;
+    std::shared_ptr<GLShared> shared = current.lock();
+    if (!shared) {
+        shared = std::make_shared<GLShared>();
+        shared->id = nextId++;
+        current = shared;
+    }
+    return shared;
+}
+
+void GLShared::init() {
+    program = makeShaderProgram(vertexShaderSrc, fragmentShaderSrc);
+
+    posLoc = glGetAttribLocation(program, "aPos");
+    uvLoc  = glGetAttribLocation(program, "aUV");
+    colorLoc = glGetAttribLocation(program, "aColor");
+    samplerLoc = glGetUniformLocation(program, "uTex");
+    transformLoc = glGetUniformLocation(program, "uTransform");
+    sdfProgram = makeShaderProgram(vertexShaderSrc, sdfFragmentShaderSrc);
+    sdfSamplerLoc = glGetUniformLocation(sdfProgram, "uTex");
+    sdfTransformLoc = glGetUniformLocation(sdfProgram, "uTransform");
+
+    // the index pattern is the same for every quad, build it once
+    std::vector<uint16_t> indices(kMaxQuadsPerIndexedDraw * kIndicesPerQuad);
+    fillQuadIndices(indices.data(), kMaxQuadsPerIndexedDraw);
+    glGenBuffers(1, &ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t), indices.data(), GL_STATIC_DRAW);
+
+    queryCaps();
+}
+
+void GLShared::destroy() {
+    for (GLuint tex : textures) glDeleteTextures(1, &tex);
+    textures.clear();
+    targets.clear();
+    sdfTextures.clear();
+    streaming.clear();
+    uploadQueue.clear();
+    uploadsPending = 0;
+    placeholderTex = 0;
+    if (pbo) glDeleteBuffers(1, &pbo);
+    if (ibo) glDeleteBuffers(1, &ibo);
+    if (program) glDeleteProgram(program);
+    if (sdfProgram) glDeleteProgram(sdfProgram);
+    pbo = ibo = program = sdfProgram = 0;
+}
+
 Renderer::Renderer() : impl(std::make_unique<Impl>()) {}
-Renderer::~Renderer() {}
 
-Renderer::Renderer(NativeParent& np, int width, int height) : Renderer() {
-    this->init( np, width, height );
+Renderer::~Renderer() {
+    if (!impl->gl) return;
+    // stop presenting before the snapshots go away
+    if (impl->threaded) RenderThread::instance().removeClient(impl.get());
+    // this context's own objects, then the group's with the last context that uses them
+    impl->onGL([this]() {
+        makeCurrent(impl->ctx);
+        for (auto& fbo : impl->fbos) glDeleteFramebuffers(1, &fbo.second.fbo);
+        impl->fbos.clear();
+        if (impl->vao) glDeleteVertexArrays(1, &impl->vao);
+        if (impl->vbo) glDeleteBuffers(1, &impl->vbo);
+        impl->vao = impl->vbo = 0;
+        if (--impl->gl->renderers == 0) impl->gl->destroy();
+    });
 }
 
-void Renderer::init(NativeParent& np, int width, int height) {
-    impl->ctx = makeSurface(np, 640, 480);
-    makeCurrent(impl->ctx);
-    // now you can init shaders, buffers, etc.
+Renderer::Renderer(NativeParent& np, int width, int height, RenderMode mode) : Renderer() {
+    this->init( np, width, height, mode );
+}
+
+void Renderer::init(NativeParent& np, int width, int height, RenderMode mode) {
+    impl->gl = GLShared::acquire();
+    if (!impl->gl->shareCtx)
+        impl->gl->threaded = mode == RenderMode::RenderThread;
+    else if (impl->gl->threaded != (mode == RenderMode::RenderThread))
+        printf("NOTE: render mode is per share group; this window follows the first one\n");
+    impl->threaded = impl->gl->threaded;
+
+    impl->ctx = makeSurface(np, width, height, impl->gl->shareCtx);
+    impl->view = Impl::Viewport{ width, height, backingScaleFactor(np) };
+    impl->pacer.setRefreshRate(displayRefreshRate(np));
 
-    impl->screenW = width;
-    impl->screenH = height;
-    glViewport(0, 0, impl->screenW, impl->screenH);
+    // a context is current on one thread at a time: hand it over to the render thread
+    if (impl->threaded) clearCurrentContext();
 
-    impl->program = impl->makeShaderProgram(vertexShaderSrc, fragmentShaderSrc);
+    impl->onGL([this]() {
+        makeCurrent(impl->ctx);
+        setSwapInterval(impl->ctx, 1); // PresentPolicy::PowerSaving, whatever the context defaulted to
+        // now you can init shaders, buffers, etc.
+        if (!impl->gl->shareCtx) {
+            impl->gl->shareCtx = impl->ctx;
+            impl->gl->init();
+            impl->gl->placeholderTex = createSolidTexture(128, 128, 128, 96);
+        }
+
+        // per context: VAOs and the vertex stream aren't shared
+        glGenBuffers(1, &impl->vbo);
+        glGenVertexArrays(1, &impl->vao);
+        glBindVertexArray(impl->vao);
+    });
+    ++impl->gl->renderers;
 
-    impl->posLoc = glGetAttribLocation(impl->program, "aPos");
-    impl->uvLoc  = glGetAttribLocation(impl->program, "aUV");
-    impl->samplerLoc = glGetUniformLocation(impl->program, "uTex");
-    impl->screenSizeLoc = glGetUniformLocation(impl->program, "uScreenSize");
+    if (impl->threaded) {
+        Impl* p = impl.get();
+        RenderThread::instance().addClient(p, [p]() { p->drawPublished(); });
+    }
+}
 
-    glGenBuffers(1, &impl->vbo);
-    glGenVertexArrays(1, &impl->vao);
-    glBindVertexArray(impl->vao);
+// texture formats/features the driver supports; decided once per context
+void GLShared::queryCaps() {
+    auto has = [](const char* name) {
+#ifdef __APPLE__
+        GLint n = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &n);
+        for (GLint i = 0; i < n; ++i)
+            if (strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), name) == 0) return true;
+        return false;
+#else
+        const char* ext = (const char*)glGetString(GL_EXTENSIONS);
+        size_t len = strlen(name);
+        for (const char* p = ext ? strstr(ext, name) : nullptr; p; p = strstr(p + len, name))
+            if ((p == ext || p[-1] == ' ') && (p[len] == ' ' || p[len] == 0)) return true;
+        return false;
+#endif
+    };
+    const char* version = (const char*)glGetString(GL_VERSION);
+    bool es3 = version && strncmp(version, "OpenGL ES 3", 11) == 0;
+    hasETC2 = es3 || has("GL_OES_compressed_ETC2_RGBA8_texture") || has("GL_ARB_ES3_compatibility");
+    hasBC7 = has("GL_ARB_texture_compression_bptc") || has("GL_EXT_texture_compression_bptc");
+#ifdef __APPLE__
+    hasNpotMips = true;
+#else
+    hasNpotMips = es3 || has("GL_OES_texture_npot") || has("GL_ARB_texture_non_power_of_two");
+#endif
 }
 
+// sizes only take effect at the next drawFrame(), and travel with that frame to the render thread
 void Renderer::resize(int width, int height) {
-    impl->screenW = width;
-    impl->screenH = height;
+    impl->view.w = width;
+    impl->view.h = height;
+    if (impl->capture) impl->capture->resize(width, height, impl->view.scale);
 }
 
 void Renderer::addQuad(const Quad& quad, unsigned int textureId) {
-    impl->drawList.push_back({quad, textureId});
+    if (impl->threaded) {
+        Impl::FrameSnapshot& f = impl->frames.writeBuffer();
+        f.quads.push_back(quad);
+        f.tex.push_back(textureId);
+        return;
+    }
+    impl->drawQuads.push_back(quad);
+    impl->drawTex.push_back(textureId);
 }
 
+static constexpr uint64_t kProfileEvery = 300; // frames per printed summary
+
 void Renderer::drawFrame() {
-    makeCurrent(impl->ctx);
+    const uint64_t submitNs = impl->profiling ? profiler::nowNs() : 0;
+    const uint64_t inputNs = impl->pendingInputNs;
+    impl->pendingInputNs = 0;
+    if (impl->profiling) impl->callerStats.begin();
 
-    glViewport(0, 0, impl->screenW, impl->screenH);
-    glDisable(GL_CULL_FACE);
+    if (impl->capture) {
+        const uint64_t now = submitNs ? submitNs : profiler::nowNs();
+        if (impl->threaded) {
+            const Impl::FrameSnapshot& f = impl->frames.writeBuffer();
+            impl->capture->frame(now, f.quads.data(), f.tex.data(), f.quads.size());
+        } else {
+            impl->capture->frame(now, impl->drawQuads.data(), impl->drawTex.data(), impl->drawQuads.size());
+        }
+    }
+
+    if (impl->threaded) {
+        // publish and go; the render thread presents the newest frame and drops any it missed
+        Impl::FrameSnapshot& f = impl->frames.writeBuffer();
+        f.view = impl->view;
+        f.submitNs = submitNs;
+        f.inputNs = inputNs;
+        impl->frames.publish();
+        Impl::FrameSnapshot& next = impl->frames.writeBuffer();
+        next.quads.clear();
+        next.tex.clear();
+        RenderThread::instance().wake();
+    } else {
+        impl->render(impl->view, impl->drawQuads.data(), impl->drawTex.data(), impl->drawQuads.size());
+        impl->afterPresent(submitNs, inputNs, "caller thread");
+    }
+    impl->endFrame();
+
+    if (impl->profiling) impl->callerStats.end(impl->threaded ? "render thread" : "caller thread", kProfileEvery);
+}
+
+// render thread: present the latest published frame, if it hasn't been yet
+void Impl::drawPublished() {
+    if (!frames.fetch()) return;
+    FrameSnapshot& f = frames.readBuffer();
+    render(f.view, f.quads.data(), f.tex.data(), f.quads.size());
+    afterPresent(f.submitNs, f.inputNs, "render thread");
+    renderAllocCheck.endFrame();
+}
+
+// right after the swap: timing, then holding an unsynchronized swap to the display rate
+void Impl::afterPresent(uint64_t submitNs, uint64_t inputNs, const char* mode) {
+    const uint64_t presentNs = profiler::nowNs();
+    if (submitNs) presentStats.presented(presentNs, submitNs, inputNs, mode, kProfileEvery);
+    if (paced) pacer.afterPresent(presentNs);
+}
+
+// one frame's GL work, on whichever thread owns the context
+void Impl::render(const Viewport& vp, const Quad* quads, GLuint* tex, size_t quadCount) {
+    makeCurrent(ctx);
+    dropStaleFramebuffers();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, (GLsizei)(vp.w * vp.scale + 0.5f), (GLsizei)(vp.h * vp.scale + 0.5f));
     glClearColor(0.5f, 0.0f, 0.5f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glUseProgram(impl->program);
-    glUniform2f(impl->screenSizeLoc, (float)impl->screenW, (float)impl->screenH);
 
-    if (impl->drawList.size() == 0)
+    // stream a slice of pending texture data
+    if (!gl->streaming.empty()) gl->pumpUploads();
+
+    if (quadCount == 0)
         printf( "nothing to draw\n" );
 
-    for (auto& qd : impl->drawList) {
-        float verts[16];
+    // top-left origin, y down
+    drawBatched(2.0f / vp.w, -2.0f / vp.h, -1.0f, 1.0f, quads, tex, quadCount);
 
-        // interleave pos + uv
-        for (int i = 0; i < 4; i++) {
-            verts[i*4 + 0] = qd.quad.verts[i*2 + 0];
-            verts[i*4 + 1] = qd.quad.verts[i*2 + 1];
-            verts[i*4 + 2] = qd.quad.uvs[i*2 + 0];
-            verts[i*4 + 3] = qd.quad.uvs[i*2 + 1];
-        }
+    swapBuffers(ctx);
+    streamVerts = FrameVector<QuadVertex>(ArenaAllocator<QuadVertex>(&renderArena));
+    renderArena.reset();
+}
 
-        glBindBuffer(GL_ARRAY_BUFFER, impl->vbo);
-        glBindVertexArray(impl->vao);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_DYNAMIC_DRAW);
+// quads (in points) into whatever framebuffer is bound: one vertex upload,
+// then one indexed draw per run of quads sharing a texture
+void Impl::drawBatched(float scaleX, float scaleY, float offsetX, float offsetY, const Quad* quads, GLuint* tex, size_t quadCount) {
+    // keep quads off anything still incomplete
+    if (!gl->streaming.empty())
+        for (size_t i = 0; i < quadCount; ++i)
+            if (gl->streaming.count(tex[i])) tex[i] = gl->placeholderTex;
+
+    glDisable(GL_CULL_FACE);
+    GLuint current = gl->program;
+    glUseProgram(current);
+    glUniform4f(gl->transformLoc, scaleX, scaleY, offsetX, offsetY);
+
+    // premultiplied alpha everywhere (see convertPixels)
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    glBindVertexArray(vao);
+    glActiveTexture(GL_TEXTURE0);
+    glUniform1i(gl->samplerLoc, 0);
+    glEnableVertexAttribArray(gl->posLoc);
+    glEnableVertexAttribArray(gl->uvLoc);
+    glEnableVertexAttribArray(gl->colorLoc);
+
+    uploadVertices(quads, quadCount);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gl->ibo);
+
+    size_t i = 0;
+    while (i < quadCount) {
+        size_t end = i + 1;
+        while (end < quadCount && end - i < kMaxQuadsPerIndexedDraw && tex[end] == tex[i]) ++end;
 
-        glEnableVertexAttribArray(impl->posLoc);
-        glVertexAttribPointer(impl->posLoc, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+        // no base-vertex in GLES2: point the attributes at the run's first vertex instead
+        const size_t base = i * kVertsPerQuad * sizeof(QuadVertex);
+        glVertexAttribPointer(gl->posLoc, 2, GL_FLOAT, GL_FALSE, sizeof(QuadVertex), (void*)(base + offsetof(QuadVertex, x)));
+        glVertexAttribPointer(gl->uvLoc, 2, GL_FLOAT, GL_FALSE, sizeof(QuadVertex), (void*)(base + offsetof(QuadVertex, u)));
+        glVertexAttribPointer(gl->colorLoc, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(QuadVertex), (void*)(base + offsetof(QuadVertex, color)));
 
-        glEnableVertexAttribArray(impl->uvLoc);
-        glVertexAttribPointer(impl->uvLoc, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+        // runs already break at texture changes, so a shader switch costs no extra draws
+        const GLuint want = !gl->sdfTextures.empty() && gl->sdfTextures.count(tex[i]) ? gl->sdfProgram : gl->program;
+        if (want != current) {
+            current = want;
+            glUseProgram(current);
+            const bool sdf = current == gl->sdfProgram;
+            glUniform4f(sdf ? gl->sdfTransformLoc : gl->transformLoc, scaleX, scaleY, offsetX, offsetY);
+            glUniform1i(sdf ? gl->sdfSamplerLoc : gl->samplerLoc, 0);
+        }
+        glBindTexture(GL_TEXTURE_2D, tex[i]);
+        glDrawElements(GL_TRIANGLES, (GLsizei)((end - i) * kIndicesPerQuad), GL_UNSIGNED_SHORT, (void*)0);
+        i = end;
+    }
+}
+
+// framebuffers aren't shared between contexts, so each one makes its own for a
+// target; with this context current
+GLuint Impl::framebufferFor(GLuint target) {
+    dropStaleFramebuffers();
+    auto t = gl->targets.find(target);
+    if (t == gl->targets.end()) return 0;
+    auto it = fbos.find(target);
+    if (it != fbos.end()) return it->second.fbo;
+    GLuint fbo = 0;
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        printf("ERROR: render target %u can't be drawn to on this driver\n", target);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &fbo);
+        return 0;
+    }
+    fbos[target] = { fbo, t->second.serial };
+    return fbo;
+}
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, qd.texId);
-        glUniform1i(impl->samplerLoc, 0);
+// targets destroyed through another context leave this one's framebuffers
+// attached to freed texture names, which GL may hand out again for a new target
+void Impl::dropStaleFramebuffers() {
+    if (seenTargetsDestroyed == gl->targetsDestroyed) return;
+    seenTargetsDestroyed = gl->targetsDestroyed;
+    for (auto it = fbos.begin(); it != fbos.end();) {
+        auto t = gl->targets.find(it->first);
+        if (t != gl->targets.end() && t->second.serial == it->second.serial) { ++it; continue; }
+        glDeleteFramebuffers(1, &it->second.fbo);
+        it = fbos.erase(it);
+    }
+}
 
-        // draw quad as triangle strip
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+// y up in NDC lands on row 0 first, so a target's rows come out top-first
+// like every uploaded image and it samples upright with plain 0..1 uvs
+void Impl::renderTarget(GLuint target, const Quad* quads, const GLuint* textureIds, size_t quadCount) {
+    makeCurrent(ctx);
+    auto it = gl->targets.find(target);
+    if (it == gl->targets.end()) {
+        printf("ERROR: renderToTarget: %u is not a render target\n", target);
+        return;
+    }
+    const GLShared::Target& t = it->second;
+    const GLuint fbo = framebufferFor(target);
+    if (!fbo) return;
 
-        // check
-        // printf("posLoc=%d uvLoc=%d samplerLoc=%d screenSizeLoc=%d\n",
-        //     impl->posLoc, impl->uvLoc, impl->samplerLoc, impl->screenSizeLoc);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, t.pixelW, t.pixelH);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    {
+        FrameVector<GLuint> tex(textureIds, textureIds + quadCount, ArenaAllocator<GLuint>(&renderArena));
+        drawBatched(2.0f / t.width, 2.0f / t.height, -1.0f, -1.0f, quads, tex.data(), quadCount);
     }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    streamVerts = FrameVector<QuadVertex>(ArenaAllocator<QuadVertex>(&renderArena));
+    renderArena.reset();
+}
+
+uint64_t Renderer::shareGroup() const {
+    return impl->gl ? impl->gl->id : 0;
+}
 
-    impl->drawList.clear();
+int Renderer::shareGroupSize() const {
+    return impl->gl ? impl->gl->renderers : 0;
+}
+
+float Renderer::contentScale() const {
+    return impl->view.scale;
+}
+
+void Renderer::setContentScale(float scale) {
+    impl->view.scale = scale > 0.0f ? scale : 1.0f;
+    if (impl->capture) impl->capture->resize(impl->view.w, impl->view.h, impl->view.scale);
+}
+
+RenderMode Renderer::renderMode() const {
+    return impl->threaded ? RenderMode::RenderThread : RenderMode::CallerThread;
+}
+
+void Renderer::setProfiling(bool enabled) {
+    impl->profiling = enabled;
+}
+
+void Renderer::noteInput(uint64_t eventTimeNs) {
+    if (!impl->pendingInputNs || eventTimeNs < impl->pendingInputNs) impl->pendingInputNs = eventTimeNs;
+}
+
+// swap interval 1 or 0; NSOpenGLContext has no late-swap tearing (adaptive vsync) control
+bool Renderer::setPresentPolicy(PresentPolicy policy) {
+    if (policy == PresentPolicy::Adaptive) return false;
+    impl->policy = policy;
+    Impl* p = impl.get();
+    auto apply = [p, policy]() {
+        setSwapInterval(p->ctx, policy == PresentPolicy::LowLatency ? 0 : 1);
+        p->paced = policy == PresentPolicy::LowLatency;
+    };
+    if (impl->threaded) RenderThread::instance().post(apply);
+    else apply();
+    return true;
+}
+
+PresentPolicy Renderer::presentPolicy() const {
+    return impl->policy;
+}
+
+std::vector<PresentPolicy> Renderer::supportedPresentPolicies() const {
+    return { PresentPolicy::PowerSaving, PresentPolicy::LowLatency };
+}
+
+PixelFormat Renderer::nativePixelFormat() const {
+    return PixelFormat::RGBA8;
+}
+
+FrameArena& Renderer::frameArena() {
+    return impl->arena;
+}
 
-    swapBuffers(impl->ctx);
+// the current size goes first, so a replay starts from the same viewport
+void Renderer::setCapture(FrameCapture* capture) {
+    impl->capture = capture;
+    if (capture) capture->resize(impl->view.w, impl->view.h, impl->view.scale);
 }
 
+// the resource calls below wait for the render thread in RenderMode::RenderThread;
+// at worst for the swap it is blocked in, after that they are a thread round trip
 unsigned int Renderer::createSolidTexture(unsigned char r, unsigned char g,
                                           unsigned char b, unsigned char a) {
-    GLuint tex;
-    glGenTextures(1, &tex);
-    glBindTexture(GL_TEXTURE_2D, tex);
+    const unsigned int id = impl->onGL([&]() {
+        GLuint tex;
+        glGenTextures(1, &tex);
+        glBindTexture(GL_TEXTURE_2D, tex);
 
-    unsigned char pixel[4] = {r, g, b, a};
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0,
-                 GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+        unsigned char pixel[4] = {r, g, b, a};
+        convertPixels(pixel, 1, PixelFormat::RGBA8, true);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, pixel);
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
-    return tex;
+        impl->gl->textures.insert(tex);
+        return tex;
+    });
+    if (impl->capture) impl->capture->createSolid(id, r, g, b, a);
+    return id;
 }
 
 unsigned int Renderer::createTexture(const Texture& tex) {
-    makeCurrent(impl->ctx);  // ensure GL context is active
-
-    GLuint texId;
-    glGenTextures(1, &texId);
-    glBindTexture(GL_TEXTURE_2D, texId);
-
-    glTexImage2D(GL_TEXTURE_2D,
-                 0,                  // mip level
-                 GL_RGBA,            // internal format
-                 tex.width,
-                 tex.height,
-                 0,                  // border
-                 GL_RGBA,            // format of pixel data
-                 GL_UNSIGNED_BYTE,   // type of pixel data
-                 tex.data);
-
-    // nearest for pixel-perfect rendering; you can change to GL_LINEAR if desired
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-    // clamp to edge to avoid bleeding
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-    return texId;
+    return createTexture(&tex, 1);
+}
+
+unsigned int Renderer::createTexture(const Texture* levels, int levelCount) {
+    const unsigned int id = impl->onGL([&]() {
+        makeCurrent(impl->ctx);  // ensure GL context is active
+
+        levelCount = impl->gl->usableLevels(levels[0].width, levels[0].height, levelCount);
+
+        GLuint texId;
+        glGenTextures(1, &texId);
+        glBindTexture(GL_TEXTURE_2D, texId);
+
+        for (int level = 0; level < levelCount; ++level) {
+            const Texture& tex = levels[level];
+            glTexImage2D(GL_TEXTURE_2D,
+                         level,              // mip level
+                         GL_RGBA,            // internal format
+                         tex.width,
+                         tex.height,
+                         0,                  // border
+                         GL_RGBA,            // format of pixel data
+                         GL_UNSIGNED_BYTE,   // type of pixel data
+                         tex.data);
+        }
+
+        // nearest for pixel-perfect rendering at 1:1; trilinear when a panel is drawn
+        // scaled down (e.g. @1x display, or the host shrinks the window)
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+        // clamp to edge to avoid bleeding
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        impl->gl->textures.insert(texId);
+        return texId;
+    });
+    if (impl->capture) impl->capture->createTexture(id, levels, levelCount);
+    return id;
+}
+
+unsigned int Renderer::reserveTexture(int width, int height, bool mipmapped) {
+    // same level sizes buildMipChain produces, with no data yet
+    std::vector<Texture> levels(1, Texture(width, height, nullptr));
+    while (mipmapped && (levels.back().width > 1 || levels.back().height > 1)) {
+        const Texture& last = levels.back();
+        levels.push_back(Texture(last.width > 1 ? last.width / 2 : 1, last.height > 1 ? last.height / 2 : 1, nullptr));
+    }
+    // the storage is created with no pixels, which is a reserve, not a createTexture, to a capture
+    FrameCapture* capture = impl->capture;
+    impl->capture = nullptr;
+    const unsigned int id = impl->onGL([&]() {
+        unsigned int texId = createTexture(levels.data(), (int)levels.size());
+
+        GLShared::Streaming& st = impl->gl->streaming[texId];
+        st.width = width;
+        st.height = height;
+        st.levelCount = impl->gl->usableLevels(width, height, (int)levels.size());
+        ++impl->gl->uploadsPending;
+        return texId;
+    });
+    impl->capture = capture;
+    if (capture) capture->reserveTexture(id, width, height, mipmapped);
+    return id;
+}
+
+void GLShared::stream(GLuint texId, TextureUpload upload) {
+    auto it = streaming.find(texId);
+    if (it == streaming.end() || it->second.hasData) {
+        printf("ERROR: streamTexture: %u is not a reserved texture\n", texId);
+        return;
+    }
+    Streaming& st = it->second;
+    st.hasData = true;
+    if (upload.levels.empty()) { // keeps drawing the placeholder
+        --uploadsPending;
+        return;
+    }
+    if (upload.levels[0].width != st.width || upload.levels[0].height != st.height ||
+        (int)upload.levels.size() < st.levelCount) {
+        printf("ERROR: streamTexture: data for %u doesn't match the reserved %dx%d, %d levels\n",
+               texId, st.width, st.height, st.levelCount);
+        --uploadsPending;
+        return;
+    }
+    st.upload = std::move(upload);
+    uploadQueue.push_back(texId);
+}
+
+// the setters below don't need an answer, so they never wait for the render thread
+void Renderer::streamTexture(unsigned int texId, TextureUpload upload) {
+    if (impl->capture) impl->capture->streamTexture(texId, upload);
+    if (!impl->threaded) return impl->gl->stream(texId, std::move(upload));
+    std::shared_ptr<GLShared> gl = impl->gl;
+    RenderThread::instance().post([gl, texId, upload]() mutable { gl->stream(texId, std::move(upload)); });
+}
+
+void Renderer::setUploadBudget(size_t bytesPerFrame) {
+    std::shared_ptr<GLShared> gl = impl->gl;
+    auto set = [gl, bytesPerFrame]() { gl->uploadBudget = bytesPerFrame ? bytesPerFrame : 1; };
+    if (impl->threaded) RenderThread::instance().post(set);
+    else set();
+}
+
+bool Renderer::uploadsPending() const {
+    return impl->gl->uploadsPending > 0;
+}
+
+void Renderer::setPlaceholderTexture(unsigned int texId) {
+    std::shared_ptr<GLShared> gl = impl->gl;
+    auto set = [gl, texId]() { gl->placeholderTex = texId; };
+    if (impl->threaded) RenderThread::instance().post(set);
+    else set();
+}
+
+void Renderer::setTextureShader(unsigned int texId, TextureShader shader) {
+    if (impl->capture) impl->capture->setTextureShader(texId, shader);
+    impl->onGL([&]() {
+        makeCurrent(impl->ctx);
+        if (shader == TextureShader::Color) {
+            impl->gl->sdfTextures.erase(texId);
+            return;
+        }
+        impl->gl->sdfTextures.insert(texId);
+        // distances must interpolate between texels; mips (if any) stay trilinear
+        glBindTexture(GL_TEXTURE_2D, texId);
+        GLint minFilter = GL_NEAREST;
+        glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, &minFilter);
+        if (minFilter == GL_NEAREST) glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    });
+}
+
+void Renderer::destroyTexture(unsigned int texId) {
+    if (impl->capture) impl->capture->destroyTexture(texId);
+    impl->onGL([&]() {
+        makeCurrent(impl->ctx);
+        GLShared& gl = *impl->gl;
+        if (!texId || gl.targets.count(texId)) return; // render targets go through destroyRenderTarget
+        auto st = gl.streaming.find(texId);
+        if (st != gl.streaming.end()) {
+            // still counted until it completes or its data is given up on
+            if (!st->second.hasData || !st->second.upload.levels.empty()) --gl.uploadsPending;
+            gl.uploadQueue.erase(std::remove(gl.uploadQueue.begin(), gl.uploadQueue.end(), texId), gl.uploadQueue.end());
+            gl.streaming.erase(st);
+        }
+        gl.sdfTextures.erase(texId);
+        if (gl.placeholderTex == texId) gl.placeholderTex = 0;
+        gl.textures.erase(texId);
+        GLuint tex = texId;
+        glDeleteTextures(1, &tex);
+    });
+}
+
+bool Renderer::supportsCompressedFormat(CompressedFormat format) const {
+    switch (format) {
+    case CompressedFormat::ETC2_RGBA8: return impl->gl->hasETC2;
+    case CompressedFormat::BC7_RGBA:   return impl->gl->hasBC7;
+    }
+    return false;
+}
+
+unsigned int Renderer::createTexture(const CompressedTexture& tex) {
+    if (!supportsCompressedFormat(tex.format)) return 0;
+    const unsigned int id = impl->onGL([&]() -> unsigned int {
+        makeCurrent(impl->ctx);
+
+        GLenum internalFormat = tex.format == CompressedFormat::BC7_RGBA ? GL_COMPRESSED_RGBA_BPTC_UNORM
+                                                                           : GL_COMPRESSED_RGBA8_ETC2_EAC;
+        GLuint texId;
+        glGenTextures(1, &texId);
+        glBindTexture(GL_TEXTURE_2D, texId);
+        glCompressedTexImage2D(GL_TEXTURE_2D, 0, internalFormat, tex.width, tex.height, 0,
+                               (GLsizei)tex.data.size(), tex.data.data());
+        if (glGetError() != GL_NO_ERROR) {
+            glDeleteTextures(1, &texId);
+            return 0;
+        }
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        impl->gl->textures.insert(texId);
+        return texId;
+    });
+    if (impl->capture && id) impl->capture->createCompressed(id, tex);
+    return id;
+}
+
+unsigned int Renderer::createRenderTarget(int width, int height) {
+    const unsigned int id = impl->onGL([&]() -> unsigned int {
+        makeCurrent(impl->ctx);
+        GLShared::Target t{ width, height, (int)(width * impl->view.scale + 0.5f), (int)(height * impl->view.scale + 0.5f),
+                            ++impl->gl->targetSerial };
+        if (t.pixelW < 1 || t.pixelH < 1) return 0;
+
+        GLuint texId;
+        glGenTextures(1, &texId);
+        glBindTexture(GL_TEXTURE_2D, texId);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, t.pixelW, t.pixelH, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        // drawn back 1:1 at the scale it was rendered at
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        impl->gl->targets[texId] = t;
+        impl->gl->textures.insert(texId);
+        return texId;
+    });
+    if (impl->capture && id) impl->capture->createTarget(id, width, height);
+    return id;
+}
+
+void Renderer::renderToTarget(unsigned int target, const Quad* quads, const unsigned int* textureIds, size_t quadCount) {
+    if (impl->capture) impl->capture->renderToTarget(target, quads, textureIds, quadCount);
+    impl->onGL([&]() { impl->renderTarget(target, quads, textureIds, quadCount); });
+}
+
+bool Renderer::readPixels(unsigned int target, std::vector<uint8_t>& rgba, int& width, int& height) {
+    return impl->onGL([&]() {
+        makeCurrent(impl->ctx);
+        auto it = impl->gl->targets.find(target);
+        const GLuint fbo = it == impl->gl->targets.end() ? 0 : impl->framebufferFor(target);
+        if (!fbo) return false;
+        const GLShared::Target& t = it->second;
+        rgba.resize((size_t)t.pixelW * t.pixelH * 4);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glReadPixels(0, 0, t.pixelW, t.pixelH, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        width = t.pixelW;
+        height = t.pixelH;
+        return true;
+    });
+}
+
+void Renderer::destroyRenderTarget(unsigned int target) {
+    if (impl->capture) impl->capture->destroyTarget(target);
+    impl->onGL([&]() {
+        makeCurrent(impl->ctx);
+        if (!impl->gl->targets.erase(target)) return;
+        ++impl->gl->targetsDestroyed; // the group's other contexts drop theirs when next current
+        auto it = impl->fbos.find(target);
+        if (it != impl->fbos.end()) {
+            glDeleteFramebuffers(1, &it->second.fbo);
+            impl->fbos.erase(it);
+        }
+        impl->gl->textures.erase(target);
+        GLuint tex = target;
+        glDeleteTextures(1, &tex);
+    });
 }
@@ -1,33 +1,98 @@
 #include "renderer.h"
 #include <vulkan/vulkan.h>
-#include <vulkan/vulkan_macos.h>
 #include "NativeParent_vk.h"
+#include "device.h"
+#include "frame_arena.h"
+#include "profiler.h"
 #include <stdexcept>
 #include <array>
 #include <cstdio>
 #include <vector>
 
 
+// One instance + device for every Renderer in the process.  Only the surface,
+// swapchain and per-window command/frame objects are created per Renderer, so
+// N editor windows cost one VkDevice (and its resources) instead of N.
+struct VkShared {
+    uint64_t id = 0;
+    int renderers = 0;
+    VkInstance instance = VK_NULL_HANDLE;
+    VkPhysicalDevice phys = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    QueueFamilies families;
+    VkQueue queue = VK_NULL_HANDLE;         // graphics
+    VkQueue presentQueue = VK_NULL_HANDLE;  // == queue unless the families differ
+    VkQueue transferQueue = VK_NULL_HANDLE; // == queue unless there is a DMA family
+
+    /// the live one, or a new (empty) one if no Renderer holds it
+    static std::shared_ptr<VkShared> acquire() {
+        static std::weak_ptr<VkShared> current;
+        static uint64_t nextId = 1;
+        std::shared_ptr<VkShared> shared = current.lock();
+        if (!shared) {
+            shared = std::make_shared<VkShared>();
+            shared->id = nextId++;
+            current = shared;
+        }
+        return shared;
+    }
+
+    ~VkShared() {
+        if (device != VK_NULL_HANDLE) vkDestroyDevice(device, nullptr);
+        if (instance != VK_NULL_HANDLE) vkDestroyInstance(instance, nullptr);
+    }
+};
+
 struct Impl {
+    std::shared_ptr<VkShared> vk;
+    // copies of the shared handles, valid while vk is held
     VkInstance instance = VK_NULL_HANDLE;
     VkSurfaceKHR surface = VK_NULL_HANDLE;
     VkPhysicalDevice phys = VK_NULL_HANDLE;
     VkDevice device = VK_NULL_HANDLE;
+    QueueFamilies families;
     VkQueue queue = VK_NULL_HANDLE;
+    VkQueue presentQueue = VK_NULL_HANDLE;
+    VkQueue transferQueue = VK_NULL_HANDLE;
     VkSwapchainKHR swapchain = VK_NULL_HANDLE;
     VkRenderPass renderPass = VK_NULL_HANDLE;
     VkFramebuffer framebuffer = VK_NULL_HANDLE;
     VkExtent2D swapchainExtent;
     VkCommandPool commandPool; // Create command pool first
+    VkCommandPool transferPool = VK_NULL_HANDLE; // uploads; commandPool when there is no DMA family
     VkCommandBuffer commandBuffer;
+    VkSemaphore renderDone = VK_NULL_HANDLE; // orders present after the draw, across queues too
 
     VkPipeline graphicsPipeline;
     VkBuffer vertexBuffer;
     VkDeviceMemory vertexBufferMemory;
 
+    float contentScale = 1.0f; // set by the host via setContentScale; the swapchain extent is already in pixels
+
+    FrameArena arena; // per-frame transient data, reset after present
+    FrameAllocCheck allocCheck;
+
+    bool profiling = false; // always RenderMode::CallerThread here, so caller and present stats are one thread
+    profiler::CallerStats callerStats;
+    profiler::PresentStats presentStats;
+    uint64_t pendingInputNs = 0; // oldest input the next frame answers
+
+    PresentPolicy policy = PresentPolicy::PowerSaving;
+    std::vector<VkPresentModeKHR> presentModes; // what the surface supports
+    VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;
+    profiler::FramePacer pacer; // for mailbox/immediate, which don't block on vsync
+    int surfaceW = 0, surfaceH = 0;
+
+    bool hasPresentMode(VkPresentModeKHR mode) const {
+        for (VkPresentModeKHR m : presentModes) if (m == mode) return true;
+        return false;
+    }
+    VkPresentModeKHR choosePresentMode(PresentPolicy p) const;
+
     void createRenderPass();
     void createFramebuffer(int w, int h);
     void createSwapchain(int w, int h);
+    void queryPresentModes();
     void createCmdBuffer();
     void createGraphicsPipeline();
     void createVertexBuffer();
@@ -164,116 +229,131 @@ static void logAvailableSurfaceFormats(VkPhysicalDevice phys, VkSurfaceKHR surfa
 
 Renderer::Renderer() : impl( new Impl() ) {}
 
-Renderer::Renderer(NativeParent& np, int w, int h) : Renderer() {
-    this->init( np, w, h );
+Renderer::Renderer(NativeParent& np, int w, int h, RenderMode mode) : Renderer() {
+    this->init( np, w, h, mode );
 }
 
-void Renderer::init(NativeParent& np, int w, int h) {
+void Renderer::init(NativeParent& np, int w, int h, RenderMode mode) {
   try {
     printf("=== Vulkan Renderer Init ===\n");
-
-    // 1. Log extensions before creating instance
-    logAvailableExtensions();
-    logAvailableLayers();
-
-    // 2. Instance
-    VkApplicationInfo ai{VK_STRUCTURE_TYPE_APPLICATION_INFO};
-    ai.pApplicationName = "gfxkit";
-    ai.apiVersion = VK_API_VERSION_1_1;
-
-    VkInstanceCreateInfo ici{VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO};
-    ici.pApplicationInfo = &ai;
-    const char* exts[] = { 
-      VK_KHR_SURFACE_EXTENSION_NAME,      // "VK_KHR_surface"
-      VK_MVK_MACOS_SURFACE_EXTENSION_NAME,// "VK_MVK_macos_surface"
-      VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME, // "VK_KHR_portability_enumeration"
-    };
-    ici.ppEnabledExtensionNames = exts;
-    ici.enabledExtensionCount = 3;
-    ici.flags = VK_INSTANCE_CREATE_ENUMERATE_PORTABILITY_BIT_KHR;
-    const bool enableValidationLayers = true;
-    const char* validationLayers[] = {};
-    if (enableValidationLayers) {
-        uint32_t availableLayerCount;
-        vkEnumerateInstanceLayerProperties(&availableLayerCount, nullptr);
-        std::vector<VkLayerProperties> availableLayers(availableLayerCount);
-        vkEnumerateInstanceLayerProperties(&availableLayerCount, availableLayers.data());
-
-        bool layerFound = false;
-        for (const char* layerName : validationLayers) {
-            for (const auto& layerProperties : availableLayers) {
-                if (strcmp(layerName, layerProperties.layerName) == 0) {
-                    layerFound = true;
-                    break;
+    if (mode == RenderMode::RenderThread)
+        printf("NOTE: the render thread is GL only for now; Vulkan draws on the caller's thread\n");
+    impl->vk = VkShared::acquire();
+    VkResult res;
+
+    if (impl->vk->instance == VK_NULL_HANDLE) {
+        // 1. Log extensions before creating instance
+        logAvailableExtensions();
+        logAvailableLayers();
+
+        // 2. Instance
+        VkApplicationInfo ai{VK_STRUCTURE_TYPE_APPLICATION_INFO};
+        ai.pApplicationName = "gfxkit";
+        ai.apiVersion = VK_API_VERSION_1_1;
+
+        VkInstanceCreateInfo ici{VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO};
+        ici.pApplicationInfo = &ai;
+        const std::vector<const char*> exts = instanceExtensions(ici.flags);
+        ici.ppEnabledExtensionNames = exts.data();
+        ici.enabledExtensionCount = (uint32_t)exts.size();
+        const bool enableValidationLayers = true;
+        const char* validationLayers[] = {};
+        if (enableValidationLayers) {
+            uint32_t availableLayerCount;
+            vkEnumerateInstanceLayerProperties(&availableLayerCount, nullptr);
+            std::vector<VkLayerProperties> availableLayers(availableLayerCount);
+            vkEnumerateInstanceLayerProperties(&availableLayerCount, availableLayers.data());
+
+            bool layerFound = false;
+            for (const char* layerName : validationLayers) {
+                for (const auto& layerProperties : availableLayers) {
+                    if (strcmp(layerName, layerProperties.layerName) == 0) {
+                        layerFound = true;
+                        break;
+                    }
+                }
+                if (!layerFound) {
+                    throw std::runtime_error("Requested validation layer not available: " + std::string(layerName));
                 }
             }
-            if (!layerFound) {
-                throw std::runtime_error("Requested validation layer not available: " + std::string(layerName));
-            }
-        }
 
-        ici.enabledLayerCount = static_cast<uint32_t>(sizeof(validationLayers) / sizeof(validationLayers[0]));
-        ici.ppEnabledLayerNames = validationLayers;
-    } else {
-        ici.enabledLayerCount = 0;
-    }
+            ici.enabledLayerCount = static_cast<uint32_t>(sizeof(validationLayers) / sizeof(validationLayers[0]));
+            ici.ppEnabledLayerNames = validationLayers;
+        } else {
+            ici.enabledLayerCount = 0;
+        }
 
-    VkResult res = vkCreateInstance(&ici, nullptr, &impl->instance);
-    if (res != VK_SUCCESS) {
-        printf("vkCreateInstance failed with VkResult = %d = %s\n", res, getVulkanResultString(res));
-        VK_CHECK( "vkCreateInstance", res );
+        res = vkCreateInstance(&ici, nullptr, &impl->vk->instance);
+        if (res != VK_SUCCESS) {
+            printf("vkCreateInstance failed with VkResult = %d = %s\n", res, getVulkanResultString(res));
+            VK_CHECK( "vkCreateInstance", res );
+        }
+        printf("Vulkan instance created successfully\n");
     }
-    printf("Vulkan instance created successfully\n");
+    impl->instance = impl->vk->instance;
 
     // 3. Surface
     try {
         impl->surface = makeSurface(impl->instance, np);
-        printf("MoltenVK surface created successfully\n");
+        printf("Window surface created successfully\n");
     } catch (const std::runtime_error& e) {
         printf("makeSurface failed: %s\n", e.what());
         throw;
     }
 
-    // 4. Physical device
-    uint32_t count = 0;
-    res = vkEnumeratePhysicalDevices(impl->instance, &count, nullptr);
-    if (res != VK_SUCCESS || count == 0) {
-        printf("No Vulkan physical devices found (VkResult=%d, count=%d)\n", res, count);
-        throw std::runtime_error("Failed to find physical device");
-    }
-
-    std::vector<VkPhysicalDevice> gpus(count);
-    res = vkEnumeratePhysicalDevices(impl->instance, &count, gpus.data());
-    if (res != VK_SUCCESS) {
-        printf("vkEnumeratePhysicalDevices failed with VkResult=%d\n", res);
-        throw std::runtime_error("Failed to enumerate physical devices");
-    }
-
-    impl->phys = gpus[0];
-    printf("Using first physical device\n");
-
-    // 5. Logical device + queue
-    float qprio = 1.0f;
-    VkDeviceQueueCreateInfo qci{VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO};
-    qci.queueFamilyIndex = 0; qci.queueCount = 1; qci.pQueuePriorities = &qprio;
-
-    VkDeviceCreateInfo dci{VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO};
-    dci.queueCreateInfoCount = 1; dci.pQueueCreateInfos = &qci;
-    const char* dc_exts[] = { 
-      "VK_KHR_swapchain"
-    };
-    dci.ppEnabledExtensionNames = dc_exts;
-    dci.enabledExtensionCount = 1;
+    if (impl->vk->device == VK_NULL_HANDLE) {
+        // 4. Physical device: the best scoring one that can present here (device.h)
+        DeviceChoice choice = pickPhysicalDevice(impl->instance, impl->surface);
+        if (choice.phys == VK_NULL_HANDLE)
+            throw std::runtime_error("No Vulkan device can draw to this window");
+        impl->vk->phys = choice.phys;
+        impl->vk->families = choice.families;
+
+        // 5. Logical device, one queue per distinct family
+        float qprio = 1.0f;
+        std::vector<VkDeviceQueueCreateInfo> qcis;
+        for (uint32_t family : choice.families.unique()) {
+            VkDeviceQueueCreateInfo qci{VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO};
+            qci.queueFamilyIndex = family; qci.queueCount = 1; qci.pQueuePriorities = &qprio;
+            qcis.push_back(qci);
+        }
 
-    res = vkCreateDevice(impl->phys, &dci, nullptr, &impl->device);
-    if (res != VK_SUCCESS) {
-        printf("vkCreateDevice failed with VkResult=%d\n", res);
-        throw std::runtime_error("vkCreateDevice failed");
+        VkDeviceCreateInfo dci{VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO};
+        dci.queueCreateInfoCount = (uint32_t)qcis.size(); dci.pQueueCreateInfos = qcis.data();
+        std::vector<const char*> dc_exts = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+        if (choice.portabilitySubset) dc_exts.push_back("VK_KHR_portability_subset");
+        dci.ppEnabledExtensionNames = dc_exts.data();
+        dci.enabledExtensionCount = (uint32_t)dc_exts.size();
+
+        res = vkCreateDevice(impl->vk->phys, &dci, nullptr, &impl->vk->device);
+        if (res != VK_SUCCESS) {
+            printf("vkCreateDevice failed with VkResult=%d\n", res);
+            throw std::runtime_error("vkCreateDevice failed");
+        }
+        const QueueFamilies& f = impl->vk->families;
+        vkGetDeviceQueue(impl->vk->device, f.graphics, 0, &impl->vk->queue);
+        vkGetDeviceQueue(impl->vk->device, f.present, 0, &impl->vk->presentQueue);
+        vkGetDeviceQueue(impl->vk->device, f.transfer, 0, &impl->vk->transferQueue);
+        printf("Logical device and queue created successfully\n");
+    } else {
+        printf("Sharing the process-wide Vulkan device (%d other windows)\n", impl->vk->renderers);
+        // picked for the first window's surface; another screen may hang off a different GPU
+        VkBool32 presents = VK_FALSE;
+        vkGetPhysicalDeviceSurfaceSupportKHR(impl->vk->phys, impl->vk->families.present, impl->surface, &presents);
+        if (!presents) printf("WARNING: the shared Vulkan device can't present to this window\n");
     }
-    vkGetDeviceQueue(impl->device, 0, 0, &impl->queue);
-    printf("Logical device and queue created successfully\n");
+    impl->phys = impl->vk->phys;
+    impl->device = impl->vk->device;
+    impl->families = impl->vk->families;
+    impl->queue = impl->vk->queue;
+    impl->presentQueue = impl->vk->presentQueue;
+    impl->transferQueue = impl->vk->transferQueue;
+    ++impl->vk->renderers;
 
     // Create Swapchain
+    impl->surfaceW = w;
+    impl->surfaceH = h;
+    impl->queryPresentModes();
     impl->createSwapchain(w, h);
 
     // Create Render Pass
@@ -348,7 +428,13 @@ void Impl::createSwapchain(int w, int h) {
         printf("Error: Vulkan surface is not valid.\n");
         throw std::runtime_error("Invalid surface");
     }
+    presentMode = choosePresentMode(policy);
+    // FIFO/immediate: as few images as allowed, so frames can't queue up ahead of the display.
+    // mailbox needs one spare to replace the pending frame in
     sci.minImageCount = capabilities.minImageCount > 1 ? capabilities.minImageCount : 2;
+    if (presentMode == VK_PRESENT_MODE_MAILBOX_KHR &&
+        (capabilities.maxImageCount == 0 || sci.minImageCount < capabilities.maxImageCount))
+        ++sci.minImageCount;
     sci.imageFormat = surfaceFormat.format;//VK_FORMAT_B8G8R8A8_UNORM;
     sci.imageColorSpace = surfaceFormat.colorSpace;//VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
     if (w == 0 || h == 0) {
@@ -365,16 +451,26 @@ void Impl::createSwapchain(int w, int h) {
     }
     sci.imageArrayLayers = 1;
     sci.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
-    sci.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    // drawn on the graphics queue, presented on the present queue
+    const uint32_t sharedFamilies[] = { families.graphics, families.present };
+    if (families.graphics != families.present) {
+        sci.imageSharingMode = VK_SHARING_MODE_CONCURRENT;
+        sci.queueFamilyIndexCount = 2;
+        sci.pQueueFamilyIndices = sharedFamilies;
+    } else {
+        sci.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    }
     sci.preTransform = capabilities.currentTransform; // VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR
     sci.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
-    sci.presentMode = VK_PRESENT_MODE_FIFO_KHR;
+    sci.presentMode = presentMode;
     sci.clipped = VK_TRUE;
+    sci.oldSwapchain = swapchain; // set when the present policy changes
 
     // Log swapchain parameters
     printf("Creating Swapchain with the following parameters:\n");
     printf(" Surface: %p\n", surface); // Log the surface pointer
     printf(" Min Image Count: %d\n", sci.minImageCount);
+    printf(" Present Mode: %d\n", sci.presentMode);
     printf(" Image Format: %d\n", sci.imageFormat);
     printf(" Color Space: %d\n", sci.imageColorSpace);
     printf(" Extent: [%d, %d]\n", sci.imageExtent.width, sci.imageExtent.height);
@@ -386,15 +482,44 @@ void Impl::createSwapchain(int w, int h) {
     }
 
     printf( "...about to call vkCreateSwapchainKHR...\n");
-    VkResult res = vkCreateSwapchainKHR(device, &sci, nullptr, &swapchain);
+    // the old one stays in `swapchain` until this one exists: a failed create
+    // leaves it (retired) for the caller to pass as oldSwapchain again
+    VkSwapchainKHR created = VK_NULL_HANDLE;
+    VkResult res = vkCreateSwapchainKHR(device, &sci, nullptr, &created);
     printf( "...after call to vkCreateSwapchainKHR...\n");
     if (res != VK_SUCCESS) {
         printf("vkCreateSwapchainKHR failed with VkResult = %d = %s\n", res, getVulkanResultString( res ) );
         VK_CHECK( "vkCreateSwapchainKHR", res )
     }
+    if (swapchain != VK_NULL_HANDLE) vkDestroySwapchainKHR(device, swapchain, nullptr);
+    swapchain = created;
     printf("Swapchain created successfully\n");
 }
 
+void Impl::queryPresentModes() {
+    uint32_t count = 0;
+    vkGetPhysicalDeviceSurfacePresentModesKHR(phys, surface, &count, nullptr);
+    presentModes.resize(count);
+    vkGetPhysicalDeviceSurfacePresentModesKHR(phys, surface, &count, presentModes.data());
+    for (VkPresentModeKHR m : presentModes) printf("Present mode available: %d\n", m);
+}
+
+// FIFO is the only mode every surface has, so each policy falls back to it
+VkPresentModeKHR Impl::choosePresentMode(PresentPolicy p) const {
+    switch (p) {
+    case PresentPolicy::LowLatency:
+        if (hasPresentMode(VK_PRESENT_MODE_MAILBOX_KHR)) return VK_PRESENT_MODE_MAILBOX_KHR;
+        if (hasPresentMode(VK_PRESENT_MODE_IMMEDIATE_KHR)) return VK_PRESENT_MODE_IMMEDIATE_KHR;
+        break;
+    case PresentPolicy::Adaptive:
+        if (hasPresentMode(VK_PRESENT_MODE_FIFO_RELAXED_KHR)) return VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+        break;
+    case PresentPolicy::PowerSaving:
+        break;
+    }
+    return VK_PRESENT_MODE_FIFO_KHR;
+}
+
 void Impl::createRenderPass() {
     // Define a render pass (dummy example; modify as needed)
     VkAttachmentDescription colorAttachment = {};
@@ -457,13 +582,28 @@ void Impl::createFramebuffer(int w, int h) {
 void Impl::createCmdBuffer() {
   VkCommandPoolCreateInfo poolInfo{};
   poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-  poolInfo.queueFamilyIndex = 0; // Ensure this is the correct family index
+  poolInfo.queueFamilyIndex = families.graphics;
   poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
 
   if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
       throw std::runtime_error("failed to create command pool!");
   }
 
+  VkSemaphoreCreateInfo semInfo{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+  if (vkCreateSemaphore(device, &semInfo, nullptr, &renderDone) != VK_SUCCESS) {
+      throw std::runtime_error("failed to create semaphore!");
+  }
+
+  // one-shot upload command buffers
+  transferPool = commandPool;
+  if (families.dedicatedTransfer()) {
+      poolInfo.queueFamilyIndex = families.transfer;
+      poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+      if (vkCreateCommandPool(device, &poolInfo, nullptr, &transferPool) != VK_SUCCESS) {
+          throw std::runtime_error("failed to create transfer command pool!");
+      }
+  }
+
   VkCommandBufferAllocateInfo allocInfo{};
   allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
   allocInfo.commandPool = commandPool;
@@ -628,8 +768,14 @@ void Impl::createVertexBuffer() {
     memcpy(data, quadVerts, (size_t)bufferSize);
     vkUnmapMemory(device, stagingBufferMemory);
 
-    // Create the vertex buffer
+    // Create the vertex buffer; written on the transfer queue, read on the graphics one
     bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    const uint32_t sharedFamilies[] = { families.graphics, families.transfer };
+    if (families.dedicatedTransfer()) {
+        bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        bufferInfo.queueFamilyIndexCount = 2;
+        bufferInfo.pQueueFamilyIndices = sharedFamilies;
+    }
     VK_CHECK("vkCreateBuffer (vertex)", vkCreateBuffer(device, &bufferInfo, nullptr, &vertexBuffer));
 
     vkGetBufferMemoryRequirements(device, vertexBuffer, &memRequirements);
@@ -641,7 +787,7 @@ void Impl::createVertexBuffer() {
     vkBindBufferMemory(device, vertexBuffer, vertexBufferMemory, 0);
 
     // Copy the data from the staging buffer to the vertex buffer
-    vkCopyBuffer(device, stagingBuffer, vertexBuffer, queue, commandPool);
+    vkCopyBuffer(device, stagingBuffer, vertexBuffer, transferQueue, transferPool);
 
     // Cleanup the staging buffer and memory
     vkDestroyBuffer(device, stagingBuffer, nullptr);
@@ -750,7 +896,14 @@ void main() {\
 
     // Color blending
     VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
-    colorBlendAttachment.blendEnable = VK_FALSE;
+    // premultiplied alpha (see convertPixels)
+    colorBlendAttachment.blendEnable = VK_TRUE;
+    colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
     colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
                                           VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
 
@@ -811,15 +964,20 @@ Renderer::~Renderer() {
     if (impl->swapchain != VK_NULL_HANDLE) {
         vkDestroySwapchainKHR(impl->device, impl->swapchain, nullptr);
     }
-    if (impl->device != VK_NULL_HANDLE) {
-        vkDestroyDevice(impl->device, nullptr);
-    }
     if (impl->surface != VK_NULL_HANDLE) {
         vkDestroySurfaceKHR(impl->instance, impl->surface, nullptr);
     }
-    if (impl->instance != VK_NULL_HANDLE) {
-        vkDestroyInstance(impl->instance, nullptr);
+    if (impl->renderDone != VK_NULL_HANDLE) {
+        vkDestroySemaphore(impl->device, impl->renderDone, nullptr);
+    }
+    if (impl->transferPool != VK_NULL_HANDLE && impl->transferPool != impl->commandPool) {
+        vkDestroyCommandPool(impl->device, impl->transferPool, nullptr);
     }
+    // device and instance go with the last Renderer holding them
+    if (impl->vk && impl->device != VK_NULL_HANDLE) {
+        --impl->vk->renderers;
+    }
+    impl->vk = nullptr;
     // if (impl->commandBuffer != VK_NULL_HANDLE) {
     //     vkDestroyCommandBuffer(impl->commandBuffer, nullptr);
     // }
@@ -833,6 +991,11 @@ Renderer::~Renderer() {
 
 // Ensure you have a valid VkRenderPass created earlier in your setup
 void Renderer::drawFrame() {
+    const uint64_t submitNs = impl->profiling ? profiler::nowNs() : 0;
+    const uint64_t inputNs = impl->pendingInputNs;
+    impl->pendingInputNs = 0;
+    if (impl->profiling) impl->callerStats.begin();
+
     // Step 1: Acquire the next image from the swapchain
     uint32_t imageIndex;
     VkResult result = vkAcquireNextImageKHR(impl->device, impl->swapchain, UINT64_MAX,
@@ -915,6 +1078,8 @@ void Renderer::drawFrame() {
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &impl->commandBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &impl->renderDone;
 
     result = vkQueueSubmit(impl->queue, 1, &submitInfo, VK_NULL_HANDLE);
     if (result != VK_SUCCESS) {
@@ -928,11 +1093,138 @@ void Renderer::drawFrame() {
     presentInfo.swapchainCount = 1;
     presentInfo.pSwapchains = &impl->swapchain;
     presentInfo.pImageIndices = &imageIndex;
+    presentInfo.waitSemaphoreCount = 1;
+    presentInfo.pWaitSemaphores = &impl->renderDone;
 
-    result = vkQueuePresentKHR(impl->queue, &presentInfo);
+    result = vkQueuePresentKHR(impl->presentQueue, &presentInfo);
     if (result == VK_ERROR_OUT_OF_DATE_KHR) {
         printf("Swapchain out of date during presentation. Need to recreate.\n");
     } else if (result != VK_SUCCESS) {
         printf("Failed to present swapchain image: %d\n", result);
     }
+
+    impl->arena.reset();
+    impl->allocCheck.endFrame();
+
+    const uint64_t presentNs = profiler::nowNs();
+    if (impl->profiling) impl->presentStats.presented(presentNs, submitNs, inputNs, "caller thread", 300);
+    if (impl->presentMode == VK_PRESENT_MODE_MAILBOX_KHR || impl->presentMode == VK_PRESENT_MODE_IMMEDIATE_KHR)
+        impl->pacer.afterPresent(presentNs);
+    if (impl->profiling) impl->callerStats.end("caller thread", 300);
+}
+
+uint64_t Renderer::shareGroup() const {
+    return impl->vk ? impl->vk->id : 0;
+}
+
+int Renderer::shareGroupSize() const {
+    return impl->vk ? impl->vk->renderers : 0;
+}
+
+float Renderer::contentScale() const {
+    return impl->contentScale;
+}
+
+void Renderer::setContentScale(float scale) {
+    impl->contentScale = scale > 0.0f ? scale : 1.0f;
+}
+
+RenderMode Renderer::renderMode() const {
+    return RenderMode::CallerThread;
+}
+
+void Renderer::setProfiling(bool enabled) {
+    impl->profiling = enabled;
+}
+
+void Renderer::noteInput(uint64_t eventTimeNs) {
+    if (!impl->pendingInputNs || eventTimeNs < impl->pendingInputNs) impl->pendingInputNs = eventTimeNs;
+}
+
+// the pacer assumes 60 Hz: core Vulkan has no display refresh query
+bool Renderer::setPresentPolicy(PresentPolicy policy) {
+    if (impl->swapchain == VK_NULL_HANDLE) { // before init: used when the swapchain is created
+        impl->policy = policy;
+        return true;
+    }
+    if (policy != PresentPolicy::PowerSaving && impl->choosePresentMode(policy) == VK_PRESENT_MODE_FIFO_KHR)
+        return false;
+    if (impl->choosePresentMode(policy) == impl->presentMode) {
+        impl->policy = policy;
+        return true;
+    }
+    const PresentPolicy previous = impl->policy;
+    const VkPresentModeKHR previousMode = impl->presentMode;
+    vkDeviceWaitIdle(impl->device);
+    impl->policy = policy;
+    try {
+        impl->createSwapchain(impl->surfaceW, impl->surfaceH);
+    } catch (const std::runtime_error& e) {
+        printf( "Runtime error: %s\n", e.what() );
+        impl->policy = previous;
+        impl->presentMode = previousMode;
+        // the attempt retired the old swapchain; make it again the way it was
+        try {
+            impl->createSwapchain(impl->surfaceW, impl->surfaceH);
+        } catch (const std::runtime_error& again) {
+            printf( "Runtime error: %s\n", again.what() );
+        }
+        return false;
+    }
+    return true;
+}
+
+PresentPolicy Renderer::presentPolicy() const {
+    return impl->policy;
+}
+
+std::vector<PresentPolicy> Renderer::supportedPresentPolicies() const {
+    std::vector<PresentPolicy> policies{ PresentPolicy::PowerSaving };
+    if (impl->choosePresentMode(PresentPolicy::Adaptive) != VK_PRESENT_MODE_FIFO_KHR)
+        policies.push_back(PresentPolicy::Adaptive);
+    if (impl->choosePresentMode(PresentPolicy::LowLatency) != VK_PRESENT_MODE_FIFO_KHR)
+        policies.push_back(PresentPolicy::LowLatency);
+    return policies;
+}
+
+PixelFormat Renderer::nativePixelFormat() const {
+    return PixelFormat::BGRA8; // matches the B8G8R8A8 swapchain; sampled without swizzle
+}
+
+// texture upload isn't wired up on this backend yet; this only answers the
+// capability question so asset selection behaves the same as on GL
+bool Renderer::supportsCompressedFormat(CompressedFormat format) const {
+    if (impl->phys == VK_NULL_HANDLE) return false;
+    VkFormat vkFormat = format == CompressedFormat::BC7_RGBA ? VK_FORMAT_BC7_UNORM_BLOCK
+                                                             : VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK;
+    VkFormatProperties props;
+    vkGetPhysicalDeviceFormatProperties(impl->phys, vkFormat, &props);
+    return (props.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
+}
+
+FrameArena& Renderer::frameArena() {
+    return impl->arena;
+}
+
+// like textures, offscreen rendering needs the quad/texture path this backend
+// doesn't have yet; callers see 0 and draw without cached layers
+unsigned int Renderer::createRenderTarget(int, int) {
+    return 0;
+}
+
+void Renderer::renderToTarget(unsigned int, const Quad*, const unsigned int*, size_t) {}
+
+bool Renderer::readPixels(unsigned int, std::vector<uint8_t>&, int&, int&) {
+    return false;
 }
+
+void Renderer::destroyRenderTarget(unsigned int) {}
+
+// nothing to free: this backend creates no textures yet
+void Renderer::destroyTexture(unsigned int) {}
+
+// no textured quads here yet; shaders/sdf_quad.frag is ready for when there are
+void Renderer::setTextureShader(unsigned int, TextureShader) {}
+
+// nothing is recorded until this backend draws quads; a capture taken here stays empty
+void Renderer::setCapture(FrameCapture*) {}
@@ -1,8 +1,10 @@
 #pragma once
 #include <memory>
 #include <array>
-
-#include <array>
+#include <cstdint>
+#include <vector>
+#include "pixel_convert.h"
+#include "compressed_texture.h"
 
 struct Quad {
   Quad() {}
@@ -13,25 +15,38 @@ struct Quad {
                 x, y + height,      // bottom-left
                 x + width, y + height }; // bottom-right
 
-      uvs = { 0.0f, 0.0f,          // top-left
-              1.0f, 0.0f,          // top-right
-              0.0f, 1.0f,          // bottom-left
-              1.0f, 1.0f };        // bottom-right
+      setUVRect( 0.0f, 0.0f, 1.0f, 1.0f );
+  }
+
+  // sample a sub-rect of the texture (filmstrip frame, atlas cell, ...)
+  void setUVRect(float u0, float v0, float u1, float v1) {
+      uvs = { u0, v0,              // top-left
+              u1, v0,              // top-right
+              u0, v1,              // bottom-left
+              u1, v1 };            // bottom-right
   }
 
+  // one tint for the whole quad
+  void setColor(uint32_t c) { colors = { c, c, c, c }; }
+
   std::array<float, 8> verts;   // x,y for 4 corners (screen space or NDC)
   std::array<float, 8> uvs;     // u,v for 4 corners
+  // ABGR (r in the low byte) per corner, multiplied with the texel and
+  // interpolated across the quad (gradients, AA fringes; see shapes.h)
+  std::array<uint32_t, 4> colors = { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF };
 };
 
 
 struct Impl;
 struct NativeParent;
+class FrameArena;
+class FrameCapture;
 
 class Texture {
 public:
     int width;
     int height;
-    char* data;  // RGBA8, row-major, 4 bytes per pixel
+    char* data;  // row-major, 4 bytes per pixel in Renderer::nativePixelFormat() order, premultiplied alpha
 
     Texture() {}
     Texture(int w, int h, char* d) { init( w, h, d ); }
@@ -43,18 +58,117 @@ public:
 };
 
 
+/// pixels for a streamed upload; owner keeps the memory behind levels alive
+/// until the renderer has copied the last row
+struct TextureUpload {
+    std::vector<Texture> levels;
+    std::shared_ptr<void> owner;
+};
+
+
+/// how a texture's texels turn into color
+enum class TextureShader {
+    Color, // premultiplied RGBA, times the quad's tint
+    Sdf,   // alpha is a signed distance to a shape's edge (0.5 on it); drawn
+           // in the quad's tint with a one-pixel anti-aliased edge at any scale
+};
+
+/// which thread talks to the GPU
+enum class RenderMode {
+    CallerThread, // drawFrame() renders and presents before it returns
+    RenderThread, // drawFrame() hands the frame to a shared render thread and returns (see render_thread.h)
+};
+
+/// how finished frames reach the display
+enum class PresentPolicy {
+    PowerSaving, // vsync'd FIFO: never tears, the GPU idles between frames (default)
+    Adaptive,    // vsync, but a frame that missed its refresh goes out at once (may tear)
+    LowLatency,  // newest frame wins (mailbox, else immediate), paced to the display rate
+};
+
+
 class Renderer {
 public:
     Renderer();
-    Renderer(NativeParent& np, int width, int height);
+    Renderer(NativeParent& np, int width, int height, RenderMode mode = RenderMode::CallerThread);
     ~Renderer();
 
-    void init(NativeParent& np, int width, int height);
+    /// width/height are in points; the backbuffer is points * contentScale() pixels.
+    /// the first Renderer of a share group picks the mode for all of them
+    void init(NativeParent& np, int width, int height, RenderMode mode = RenderMode::CallerThread);
+    RenderMode renderMode() const;
+    /// print caller-blocked time, submit->present and input->present latency and
+    /// present jitter every few hundred frames
+    void setProfiling(bool enabled);
+    /// steady-clock time (Event::timeNs) of input the next drawFrame() responds to
+    void noteInput(uint64_t eventTimeNs);
+
+    /// false (and nothing changes) if the device/platform can't present that way
+    bool setPresentPolicy(PresentPolicy policy);
+    PresentPolicy presentPolicy() const;
+    std::vector<PresentPolicy> supportedPresentPolicies() const;
     void resize(int width, int height);
     void addQuad(const Quad& quad, unsigned int textureId);
     void drawFrame();
     unsigned int createSolidTexture(unsigned char r, unsigned char g, unsigned char b, unsigned char a);
     unsigned int createTexture(const Texture& tex);
+    /// levels[0] is full size, each next one half of the previous (see buildMipChain)
+    unsigned int createTexture(const Texture* levels, int levelCount);
+
+    /// upload an offline-compressed texture as-is; 0 if the device can't sample
+    /// the format, in which case the caller falls back to the RGBA path
+    unsigned int createTexture(const CompressedTexture& tex);
+    bool supportsCompressedFormat(CompressedFormat format) const;
+
+    /// texture storage with no contents yet; quads using it draw the placeholder
+    /// texture until its streamTexture() data has been fully uploaded
+    unsigned int reserveTexture(int width, int height, bool mipmapped);
+    /// pixels for a reserved texture, copied in row slices at the start of drawFrame().
+    /// an upload with no levels means the data isn't coming (decode failed); the placeholder stays
+    void streamTexture(unsigned int texId, TextureUpload upload);
+    /// max texel bytes streamed per frame (at least one row always goes)
+    void setUploadBudget(size_t bytesPerFrame);
+    bool uploadsPending() const;
+    /// drawn in place of a texture that is still streaming (default: translucent grey)
+    void setPlaceholderTexture(unsigned int texId);
+    /// pick the fragment shader quads using texId are drawn with (default Color);
+    /// Sdf also switches the texture to linear filtering, which distance fields need
+    void setTextureShader(unsigned int texId, TextureShader shader);
+    /// free a texture from any of the create/reserve calls above, including one still
+    /// streaming.  quads submitted after this must not use it; render targets go
+    /// through destroyRenderTarget()
+    void destroyTexture(unsigned int texId);
+
+    /// offscreen color buffer of width x height points (contentScale() pixels each).
+    /// the id draws like a texture in addQuad(); 0 if the backend can't render offscreen
+    unsigned int createRenderTarget(int width, int height);
+    /// clear target to transparent and draw quads into it (points, top-left origin).
+    /// done before this returns, so every frame submitted afterwards sees the result
+    void renderToTarget(unsigned int target, const Quad* quads, const unsigned int* textureIds, size_t quadCount);
+    /// target's pixels: premultiplied RGBA8, top row first, width x height in device pixels
+    bool readPixels(unsigned int target, std::vector<uint8_t>& rgba, int& width, int& height);
+    void destroyRenderTarget(unsigned int target);
+
+    /// device pixels per layout point (2 on Retina); the layout stays in points
+    float contentScale() const;
+    /// e.g. when the host moves the window to a display with a different scale
+    void setContentScale(float scale);
+
+    /// channel order textures should be converted to at import (see convertPixels)
+    PixelFormat nativePixelFormat() const;
+
+    /// every Renderer in a process shares one GL share group / VkDevice; caches of
+    /// GPU objects (textures, glyph atlas) key on this instead of the Renderer
+    uint64_t shareGroup() const;
+    /// Renderers currently alive in this share group (open editor windows)
+    int shareGroupSize() const;
+
+    /// scratch memory valid until the end of the current drawFrame(); use for per-frame data
+    FrameArena& frameArena();
+
+    /// record every resource and frame call into capture (see capture.h) until
+    /// set back to nullptr; capture must outlive that.  caller's thread only
+    void setCapture(FrameCapture* capture);
 
 private:
     std::unique_ptr<Impl> impl;
@@ -0,0 +1,15 @@
+#version 450
+// distance-field variant of textured_quad.frag (same vertex stage):
+// alpha is a signed distance, 0.5 on the edge (see tools/sdfgen)
+layout(location=0) in vec2 vUV;
+layout(location=1) in vec4 vColor; // premultiplied tint
+
+layout(location=0) out vec4 outColor;
+
+layout(set=0, binding=0) uniform sampler2D tex0; // linear filtering
+
+void main(){
+  float d = texture(tex0, vUV).a;
+  float w = max(fwidth(d), 1.0 / 255.0); // distance change per screen pixel
+  outColor = vColor * clamp((d - 0.5) / w + 0.5, 0.0, 1.0);
+}
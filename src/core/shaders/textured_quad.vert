@@ -8,11 +8,13 @@ layout(push_constant) uniform PC {
 } pc;
 
 layout(location=0) out vec2 vUV;
-layout(location=1) flat out uint vColor;
+layout(location=1) out vec4 vColor; // premultiplied, interpolated per corner
 
 void main(){
   vec3 p = pc.m * vec3(inPos, 1.0);
   gl_Position = vec4(p.xy, 0.0, 1.0);
   vUV = inUV;
-  vColor = inColor;
+  // unpacked here so gradients and AA fringes blend between corners
+  vec4 c = unpackUnorm4x8(inColor); // ABGR bytes -> rgba
+  vColor = vec4(c.rgb * c.a, c.a);  // straight alpha tint -> premultiplied
 }
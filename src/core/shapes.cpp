@@ -0,0 +1,96 @@
+#include "shapes.h"
+#include <algorithm>
+#include <cmath>
+
+static uint32_t transparent(uint32_t color) { return color & 0x00FFFFFFu; }
+
+static uint32_t scaleAlpha(uint32_t color, float f) {
+    uint32_t a = (uint32_t)((color >> 24) * f + 0.5f);
+    return transparent(color) | (std::min(a, 255u) << 24);
+}
+
+// corners in Quad order (tl, tr, bl, br): drawn as triangles 0-1-2 and 1-3-2
+Quad& ShapeBuilder::push(float x0, float y0, float x1, float y1, float x2, float y2, float x3, float y3) {
+    out.emplace_back();
+    Quad& q = out.back();
+    q.verts = { x0, y0, x1, y1, x2, y2, x3, y3 };
+    q.uvs = { u, v, u, v, u, v, u, v };
+    return q;
+}
+
+void ShapeBuilder::rect(float x, float y, float w, float h, uint32_t color) {
+    push(x, y, x + w, y, x, y + h, x + w, y + h).setColor(color);
+}
+
+void ShapeBuilder::gradient(float x, float y, float w, float h, uint32_t tl, uint32_t tr, uint32_t bl, uint32_t br) {
+    push(x, y, x + w, y, x, y + h, x + w, y + h).colors = { tl, tr, bl, br };
+}
+
+void ShapeBuilder::line(float x0, float y0, float x1, float y1, float width, uint32_t color) {
+    float dx = x1 - x0, dy = y1 - y0;
+    const float len = std::sqrt(dx * dx + dy * dy);
+    if (len <= 0.0f) return;
+    const float nx = -dy / len, ny = dx / len;
+
+    // the solid core is inset by half the feather and each fringe straddles
+    // the ideal edge, so total coverage matches the width
+    float core = (width - feather) * 0.5f;
+    float outer = (width + feather) * 0.5f;
+    if (core < 0.0f) { // hairline: drawn one feather wide, faded by how much of it the line covers
+        color = scaleAlpha(color, width / feather);
+        core = 0.0f;
+        outer = feather;
+    }
+    const uint32_t clear = transparent(color);
+    if (core > 0.0f)
+        push(x0 + nx * core, y0 + ny * core, x1 + nx * core, y1 + ny * core,
+             x0 - nx * core, y0 - ny * core, x1 - nx * core, y1 - ny * core).setColor(color);
+    for (float side : { 1.0f, -1.0f }) {
+        const float ix = nx * core * side, iy = ny * core * side;
+        const float ox = nx * outer * side, oy = ny * outer * side;
+        push(x0 + ix, y0 + iy, x1 + ix, y1 + iy, x0 + ox, y0 + oy, x1 + ox, y1 + oy).colors = { color, color, clear, clear };
+    }
+}
+
+void ShapeBuilder::roundedRect(float x, float y, float w, float h, float radius, uint32_t color) {
+    if (w <= 0.0f || h <= 0.0f) return;
+    radius = std::max(0.0f, std::min(radius, std::min(w, h) * 0.5f));
+
+    // the outline walks the four corner arcs clockwise (y down) starting at
+    // the top-right; each arc point's outward normal is its radial direction.
+    // with no radius a corner is one point whose "normal" is the miter
+    // (±1, ±1), which offsets both edges by the same amount
+    const int segments = radius < 0.5f ? 0 : std::min(16, std::max(2, (int)std::ceil(radius * 0.5f)));
+    const int points = 4 * (segments + 1);
+    const float inset = feather * 0.5f;
+    const float cx[4] = { x + w - radius, x + w - radius, x + radius, x + radius };
+    const float cy[4] = { y + radius, y + h - radius, y + h - radius, y + radius };
+    const float start[4] = { -1.5707963f, 0.0f, 1.5707963f, 3.1415927f }; // -90, 0, 90, 180 degrees
+    const float miterX[4] = { 1.0f, 1.0f, -1.0f, -1.0f }, miterY[4] = { -1.0f, 1.0f, 1.0f, -1.0f };
+    auto point = [&](int k, float& px, float& py, float& nx, float& ny) {
+        const int corner = k / (segments + 1), step = k % (segments + 1);
+        if (segments == 0) { nx = miterX[corner]; ny = miterY[corner]; }
+        else {
+            const float a = start[corner] + 1.5707963f * step / segments;
+            nx = std::cos(a);
+            ny = std::sin(a);
+        }
+        px = cx[corner] + nx * radius;
+        py = cy[corner] + ny * radius;
+    };
+
+    const uint32_t clear = transparent(color);
+    const float mx = x + w * 0.5f, my = y + h * 0.5f;
+    float px, py, nx, ny;
+    point(points - 1, px, py, nx, ny);
+    for (int k = 0; k < points; ++k) {
+        float qx, qy, mx2, my2;
+        point(k, qx, qy, mx2, my2);
+        // fill: a triangle from the center to this edge, inset by half the feather
+        const float ax = px - nx * inset, ay = py - ny * inset, bx = qx - mx2 * inset, by = qy - my2 * inset;
+        push(mx, my, ax, ay, mx, my, bx, by).setColor(color);
+        // fringe: from the inset edge out to half a feather past the ideal one
+        push(ax, ay, bx, by, px + nx * inset, py + ny * inset, qx + mx2 * inset, qy + my2 * inset).colors = { color, color, clear, clear };
+        px = qx; py = qy; nx = mx2; ny = my2;
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "renderer.h"
+
+// Flat, gradient and anti-aliased shapes made of ordinary quads.  Every quad
+// samples one opaque white texel of a texture the caller already draws with
+// (the glyph atlas), so the color is all per-corner tint and shapes batch
+// into the same draw call as the art and text around them.  No shader
+// support is needed:
+//
+// - a gradient is a quad with different corner colors
+// - a triangle is a quad with two corners on the same point
+// - edges are anti-aliased by a fringe: a strip `feather` wide whose outer
+//   corners have the fill color at alpha 0, so coverage ramps across it
+//
+// Colors are ABGR with straight alpha, like Quad::colors.
+
+class ShapeBuilder {
+public:
+    /// quads are appended to out; (whiteU, whiteV) is a uv of opaque white
+    ShapeBuilder(std::vector<Quad>& out, float whiteU, float whiteV) : out(out), u(whiteU), v(whiteV) {}
+
+    /// width of the AA ramp in points; one device pixel (1 / contentScale) is sharpest
+    float feather = 1.0f;
+
+    /// hard-edged rect (for pixel-aligned panels and bars)
+    void rect(float x, float y, float w, float h, uint32_t color);
+    /// colors at the top-left, top-right, bottom-left and bottom-right corner
+    void gradient(float x, float y, float w, float h, uint32_t tl, uint32_t tr, uint32_t bl, uint32_t br);
+    void verticalGradient(float x, float y, float w, float h, uint32_t top, uint32_t bottom) {
+        gradient(x, y, w, h, top, top, bottom, bottom);
+    }
+    void horizontalGradient(float x, float y, float w, float h, uint32_t left, uint32_t right) {
+        gradient(x, y, w, h, left, right, left, right);
+    }
+
+    /// anti-aliased segment with butt ends; thinner than feather fades instead of vanishing
+    void line(float x0, float y0, float x1, float y1, float width, uint32_t color);
+    /// anti-aliased filled rect with round corners (radius 0 gives a square-cornered one)
+    void roundedRect(float x, float y, float w, float h, float radius, uint32_t color);
+
+private:
+    std::vector<Quad>& out;
+    float u, v;
+
+    Quad& push(float x0, float y0, float x1, float y1, float x2, float y2, float x3, float y3);
+};
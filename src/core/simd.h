@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+
+// Minimal portable 4-wide float SIMD: SSE2 on x86, NEON on ARM (Pi, Apple
+// Silicon), plain arrays everywhere else.  Only the handful of operations the
+// core kernels need; add more here rather than sprinkling intrinsics around.
+//
+// Define SUBA_SIMD_SCALAR to force the fallback (useful for checking a kernel
+// against its reference).
+
+#if !defined(SUBA_SIMD_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define SUBA_SIMD_SSE2 1
+#include <emmintrin.h>
+#elif !defined(SUBA_SIMD_SCALAR) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define SUBA_SIMD_NEON 1
+#include <arm_neon.h>
+#else
+#define SUBA_SIMD_SCALAR_FALLBACK 1
+#endif
+
+namespace simd {
+
+#if SUBA_SIMD_SSE2
+
+struct f32x4 { __m128 v; };
+inline f32x4 load(const float* p)          { return { _mm_loadu_ps(p) }; }
+inline void  store(float* p, f32x4 a)      { _mm_storeu_ps(p, a.v); }
+inline f32x4 splat(float s)                { return { _mm_set1_ps(s) }; }
+inline f32x4 add(f32x4 a, f32x4 b)         { return { _mm_add_ps(a.v, b.v) }; }
+inline f32x4 mul(f32x4 a, f32x4 b)         { return { _mm_mul_ps(a.v, b.v) }; }
+inline f32x4 min(f32x4 a, f32x4 b)         { return { _mm_min_ps(a.v, b.v) }; }
+inline f32x4 max(f32x4 a, f32x4 b)         { return { _mm_max_ps(a.v, b.v) }; }
+/// { a0, a1, b0, b1 }
+inline f32x4 lowHalves(f32x4 a, f32x4 b)   { return { _mm_movelh_ps(a.v, b.v) }; }
+/// { a2, a3, b2, b3 }
+inline f32x4 highHalves(f32x4 a, f32x4 b)  { return { _mm_movehl_ps(b.v, a.v) }; }
+
+#elif SUBA_SIMD_NEON
+
+struct f32x4 { float32x4_t v; };
+inline f32x4 load(const float* p)          { return { vld1q_f32(p) }; }
+inline void  store(float* p, f32x4 a)      { vst1q_f32(p, a.v); }
+inline f32x4 splat(float s)                { return { vdupq_n_f32(s) }; }
+inline f32x4 add(f32x4 a, f32x4 b)         { return { vaddq_f32(a.v, b.v) }; }
+inline f32x4 mul(f32x4 a, f32x4 b)         { return { vmulq_f32(a.v, b.v) }; }
+inline f32x4 min(f32x4 a, f32x4 b)         { return { vminq_f32(a.v, b.v) }; }
+inline f32x4 max(f32x4 a, f32x4 b)         { return { vmaxq_f32(a.v, b.v) }; }
+inline f32x4 lowHalves(f32x4 a, f32x4 b)   { return { vcombine_f32(vget_low_f32(a.v), vget_low_f32(b.v)) }; }
+inline f32x4 highHalves(f32x4 a, f32x4 b)  { return { vcombine_f32(vget_high_f32(a.v), vget_high_f32(b.v)) }; }
+
+#else
+
+struct f32x4 { float v[4]; };
+inline f32x4 load(const float* p)          { return { { p[0], p[1], p[2], p[3] } }; }
+inline void  store(float* p, f32x4 a)      { for (int i = 0; i < 4; ++i) p[i] = a.v[i]; }
+inline f32x4 splat(float s)                { return { { s, s, s, s } }; }
+inline f32x4 add(f32x4 a, f32x4 b)         { return { { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] } }; }
+inline f32x4 mul(f32x4 a, f32x4 b)         { return { { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] } }; }
+inline f32x4 min(f32x4 a, f32x4 b)         { f32x4 r; for (int i = 0; i < 4; ++i) r.v[i] = b.v[i] < a.v[i] ? b.v[i] : a.v[i]; return r; }
+inline f32x4 max(f32x4 a, f32x4 b)         { f32x4 r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] < b.v[i] ? b.v[i] : a.v[i]; return r; }
+inline f32x4 lowHalves(f32x4 a, f32x4 b)   { return { { a.v[0], a.v[1], b.v[0], b.v[1] } }; }
+inline f32x4 highHalves(f32x4 a, f32x4 b)  { return { { a.v[2], a.v[3], b.v[2], b.v[3] } }; }
+
+#endif
+
+} // namespace simd
@@ -0,0 +1,265 @@
+#include "soft_renderer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+SoftRenderer::SoftRenderer(int width, int height, float scale) {
+    view.scale = scale > 0.0f ? scale : 1.0f;
+    resize(width, height);
+    placeholder = createSolidTexture(128, 128, 128, 96); // GL's default
+}
+
+void SoftRenderer::resize(int width, int height) {
+    view.w = width;
+    view.h = height;
+}
+
+void SoftRenderer::setContentScale(float scale) {
+    view.scale = scale > 0.0f ? scale : 1.0f;
+}
+
+void SoftRenderer::addQuad(const Quad& quad, unsigned int textureId) {
+    quads.push_back(quad);
+    tex.push_back(textureId);
+}
+
+void SoftRenderer::drawFrame() {
+    for (auto& p : pending) {
+        auto it = images.find(p.first);
+        if (it == images.end() || p.second.levels.empty()) continue;
+        const Texture& level = p.second.levels[0];
+        Image& img = it->second;
+        if (level.width != img.width || level.height != img.height) {
+            printf("ERROR: streamTexture: data for %u doesn't match the reserved %dx%d\n", p.first, img.width, img.height);
+            continue;
+        }
+        memcpy(img.rgba.data(), level.data, img.rgba.size());
+        img.reserved = false;
+    }
+    pending.clear();
+
+    frame.width = (int)(view.w * view.scale + 0.5f);
+    frame.height = (int)(view.h * view.scale + 0.5f);
+    frame.rgba.resize((size_t)frame.width * frame.height * 4);
+    for (size_t i = 0; i < frame.rgba.size(); i += 4) { // GL's clear color
+        frame.rgba[i] = 128; frame.rgba[i + 1] = 0; frame.rgba[i + 2] = 128; frame.rgba[i + 3] = 255;
+    }
+    if (view.w > 0 && view.h > 0)
+        draw(frame, (float)frame.width / view.w, (float)frame.height / view.h, quads.data(), tex.data(), quads.size());
+    quads.clear();
+    tex.clear();
+}
+
+unsigned int SoftRenderer::createSolidTexture(unsigned char r, unsigned char g, unsigned char b, unsigned char a) {
+    uint8_t pixel[4] = { r, g, b, a };
+    convertPixels(pixel, 1, PixelFormat::RGBA8, true);
+    Texture t(1, 1, (char*)pixel);
+    return createTexture(&t, 1);
+}
+
+unsigned int SoftRenderer::createTexture(const Texture* levels, int levelCount) {
+    if (levelCount < 1) return 0;
+    Image& img = images[nextId];
+    img.width = levels[0].width;
+    img.height = levels[0].height;
+    img.rgba.assign((size_t)img.width * img.height * 4, 0);
+    if (levels[0].data) memcpy(img.rgba.data(), levels[0].data, img.rgba.size());
+    return nextId++;
+}
+
+unsigned int SoftRenderer::reserveTexture(int width, int height, bool) {
+    Texture t(width, height, nullptr);
+    unsigned int id = createTexture(&t, 1);
+    images[id].reserved = true;
+    return id;
+}
+
+void SoftRenderer::streamTexture(unsigned int texId, TextureUpload upload) {
+    auto it = images.find(texId);
+    if (it == images.end() || !it->second.reserved) {
+        printf("ERROR: streamTexture: %u is not a reserved texture\n", texId);
+        return;
+    }
+    pending.emplace_back(texId, std::move(upload));
+}
+
+void SoftRenderer::setTextureShader(unsigned int texId, TextureShader shader) {
+    auto it = images.find(texId);
+    if (it != images.end()) it->second.sdf = shader == TextureShader::Sdf;
+}
+
+void SoftRenderer::destroyTexture(unsigned int texId) {
+    auto it = images.find(texId);
+    if (it == images.end() || it->second.pointW) return; // render targets go through destroyRenderTarget
+    images.erase(it);
+    pending.erase(std::remove_if(pending.begin(), pending.end(), [texId](const auto& p) { return p.first == texId; }),
+                  pending.end());
+}
+
+unsigned int SoftRenderer::createRenderTarget(int width, int height) {
+    Image img;
+    img.pointW = width;
+    img.pointH = height;
+    img.width = (int)(width * view.scale + 0.5f);
+    img.height = (int)(height * view.scale + 0.5f);
+    if (img.width < 1 || img.height < 1) return 0;
+    img.rgba.assign((size_t)img.width * img.height * 4, 0);
+    images[nextId] = std::move(img);
+    return nextId++;
+}
+
+void SoftRenderer::renderToTarget(unsigned int target, const Quad* quads, const unsigned int* textureIds, size_t quadCount) {
+    auto it = images.find(target);
+    if (it == images.end() || !it->second.pointW) {
+        printf("ERROR: renderToTarget: %u is not a render target\n", target);
+        return;
+    }
+    Image& img = it->second;
+    std::fill(img.rgba.begin(), img.rgba.end(), 0);
+    draw(img, (float)img.width / img.pointW, (float)img.height / img.pointH, quads, textureIds, quadCount);
+}
+
+bool SoftRenderer::readPixels(unsigned int target, std::vector<uint8_t>& rgba, int& width, int& height) {
+    auto it = images.find(target);
+    if (it == images.end() || !it->second.pointW) return false;
+    rgba = it->second.rgba;
+    width = it->second.width;
+    height = it->second.height;
+    return true;
+}
+
+void SoftRenderer::destroyRenderTarget(unsigned int target) {
+    auto it = images.find(target);
+    if (it != images.end() && it->second.pointW) images.erase(it);
+}
+
+void SoftRenderer::readFrame(std::vector<uint8_t>& rgba, int& width, int& height) const {
+    rgba = frame.rgba;
+    width = frame.width;
+    height = frame.height;
+}
+
+// unknown ids draw nothing, like an unbound texture
+const SoftRenderer::Image* SoftRenderer::source(unsigned int texId) const {
+    auto it = images.find(texId);
+    if (it == images.end()) return nullptr;
+    if (it->second.reserved) {
+        auto ph = images.find(placeholder);
+        return ph != images.end() && !ph->second.reserved ? &ph->second : nullptr;
+    }
+    return &it->second;
+}
+
+// points -> dst pixels by (sx, sy); the quad's corners tl, tr, bl, br make
+// triangles 0,1,2 and 1,3,2 like the GPU index pattern
+void SoftRenderer::draw(Image& dst, float sx, float sy, const Quad* quads, const unsigned int* textureIds, size_t quadCount) const {
+    static const int kTriangles[2][3] = { { 0, 1, 2 }, { 1, 3, 2 } };
+    for (size_t q = 0; q < quadCount; ++q) {
+        const Image* src = source(textureIds[q]);
+        if (!src || src == &dst) continue;
+        const Quad& quad = quads[q];
+        // the vertex shader's tint: straight color in, premultiplied out
+        float colors[4][4];
+        for (int c = 0; c < 4; ++c) {
+            const uint32_t abgr = quad.colors[c];
+            const float a = (float)(abgr >> 24) / 255.0f;
+            colors[c][0] = (float)(abgr & 0xFF) / 255.0f * a;
+            colors[c][1] = (float)((abgr >> 8) & 0xFF) / 255.0f * a;
+            colors[c][2] = (float)((abgr >> 16) & 0xFF) / 255.0f * a;
+            colors[c][3] = a;
+        }
+        for (const int* t : kTriangles) {
+            float x[3], y[3], u[3], v[3], col[3][4];
+            for (int k = 0; k < 3; ++k) {
+                x[k] = quad.verts[t[k] * 2] * sx;
+                y[k] = quad.verts[t[k] * 2 + 1] * sy;
+                u[k] = quad.uvs[t[k] * 2];
+                v[k] = quad.uvs[t[k] * 2 + 1];
+                memcpy(col[k], colors[t[k]], sizeof(col[k]));
+            }
+            triangle(dst, x, y, u, v, col, *src);
+        }
+    }
+}
+
+void SoftRenderer::triangle(Image& dst, const float* x, const float* y, const float* u, const float* v,
+                            const float (*color)[4], const Image& src) const {
+    float area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+    if (area == 0.0f) return;
+    // one winding, so the diagonal two triangles share is walked in opposite
+    // directions and the fill rule below gives each of its pixels to one of them
+    int i0 = 0, i1 = 1, i2 = 2;
+    if (area < 0.0f) { std::swap(i1, i2); area = -area; }
+    const int idx[3] = { i0, i1, i2 };
+
+    const int minX = std::max(0, (int)std::floor(std::min({ x[0], x[1], x[2] })));
+    const int maxX = std::min(dst.width - 1, (int)std::ceil(std::max({ x[0], x[1], x[2] })));
+    const int minY = std::max(0, (int)std::floor(std::min({ y[0], y[1], y[2] })));
+    const int maxY = std::min(dst.height - 1, (int)std::ceil(std::max({ y[0], y[1], y[2] })));
+
+    // edge k runs from vertex idx[k+1] to idx[k+2]; its weight goes to vertex idx[k]
+    float ex[3], ey[3], ox[3], oy[3];
+    bool inclusive[3];
+    for (int k = 0; k < 3; ++k) {
+        const int a = idx[(k + 1) % 3], b = idx[(k + 2) % 3];
+        ox[k] = x[a]; oy[k] = y[a];
+        ex[k] = x[b] - x[a]; ey[k] = y[b] - y[a];
+        inclusive[k] = ey[k] > 0.0f || (ey[k] == 0.0f && ex[k] < 0.0f);
+    }
+
+    const float inv = 1.0f / area;
+    const bool sdf = src.sdf;
+    for (int py = minY; py <= maxY; ++py) {
+        const float cy = (float)py + 0.5f;
+        uint8_t* row = dst.rgba.data() + (size_t)py * dst.width * 4;
+        for (int px = minX; px <= maxX; ++px) {
+            const float cx = (float)px + 0.5f;
+            float w[3];
+            bool inside = true;
+            for (int k = 0; k < 3; ++k) {
+                w[k] = ex[k] * (cy - oy[k]) - ey[k] * (cx - ox[k]);
+                if (w[k] < 0.0f || (w[k] == 0.0f && !inclusive[k])) { inside = false; break; }
+            }
+            if (!inside) continue;
+
+            float tu = 0.0f, tv = 0.0f, c[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            for (int k = 0; k < 3; ++k) {
+                const float b = w[k] * inv;
+                const int vi = idx[k];
+                tu += u[vi] * b;
+                tv += v[vi] * b;
+                for (int ch = 0; ch < 4; ++ch) c[ch] += color[vi][ch] * b;
+            }
+
+            float s[4];
+            if (sdf) {
+                // bilinear alpha, then GL's edge without derivatives
+                const float fx = tu * src.width - 0.5f, fy = tv * src.height - 0.5f;
+                const int x0 = (int)std::floor(fx), y0 = (int)std::floor(fy);
+                const float ax = fx - x0, ay = fy - y0;
+                auto alpha = [&src](int tx, int ty) {
+                    tx = std::min(std::max(tx, 0), src.width - 1);
+                    ty = std::min(std::max(ty, 0), src.height - 1);
+                    return (float)src.rgba[((size_t)ty * src.width + tx) * 4 + 3] / 255.0f;
+                };
+                const float d = (alpha(x0, y0) * (1 - ax) + alpha(x0 + 1, y0) * ax) * (1 - ay) +
+                                (alpha(x0, y0 + 1) * (1 - ax) + alpha(x0 + 1, y0 + 1) * ax) * ay;
+                const float cov = std::min(std::max((d - 0.5f) / 0.06f + 0.5f, 0.0f), 1.0f);
+                for (int ch = 0; ch < 4; ++ch) s[ch] = c[ch] * cov;
+            } else {
+                const int tx = std::min(std::max((int)std::floor(tu * src.width), 0), src.width - 1);
+                const int ty = std::min(std::max((int)std::floor(tv * src.height), 0), src.height - 1);
+                const uint8_t* texel = src.rgba.data() + ((size_t)ty * src.width + tx) * 4;
+                for (int ch = 0; ch < 4; ++ch) s[ch] = (float)texel[ch] / 255.0f * c[ch];
+            }
+
+            uint8_t* d = row + (size_t)px * 4;
+            const float keep = 1.0f - s[3];
+            for (int ch = 0; ch < 4; ++ch) {
+                const float out = s[ch] * 255.0f + (float)d[ch] * keep;
+                d[ch] = (uint8_t)std::min(out + 0.5f, 255.0f);
+            }
+        }
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "renderer.h"
+
+// Headless stand-in for Renderer: the same quad and texture calls, rasterized
+// on the CPU into an image you can read back.  For replaying captures and
+// comparing images where there is no window or GPU, not for shipping frames.
+//
+// It follows the GL backend's rules closely enough that a panel looks the
+// same: points times contentScale() are device pixels, pixel centers are
+// sampled, two triangles per quad with uv and color interpolated, textures
+// premultiplied RGBA8 blended ONE / ONE_MINUS_SRC_ALPHA, placeholder while a
+// reserved texture has no data.  Differences: level 0 only, nearest sampling
+// (linear for Sdf textures), the Sdf edge is the fixed-width one GL uses
+// without derivatives, and compressed textures aren't supported.
+
+class SoftRenderer {
+public:
+    SoftRenderer(int width, int height, float scale = 1.0f);
+
+    void resize(int width, int height);
+    float contentScale() const { return view.scale; }
+    void setContentScale(float scale);
+    PixelFormat nativePixelFormat() const { return PixelFormat::RGBA8; }
+
+    void addQuad(const Quad& quad, unsigned int textureId);
+    /// rasterize the queued quads into the frame (see readFrame) and start a new one
+    void drawFrame();
+
+    unsigned int createSolidTexture(unsigned char r, unsigned char g, unsigned char b, unsigned char a);
+    unsigned int createTexture(const Texture& tex) { return createTexture(&tex, 1); }
+    unsigned int createTexture(const Texture* levels, int levelCount);
+    unsigned int createTexture(const CompressedTexture&) { return 0; }
+    bool supportsCompressedFormat(CompressedFormat) const { return false; }
+    unsigned int reserveTexture(int width, int height, bool mipmapped);
+    /// takes effect at the next drawFrame(), all at once (there is no upload budget to spread)
+    void streamTexture(unsigned int texId, TextureUpload upload);
+    bool uploadsPending() const { return !pending.empty(); }
+    void setPlaceholderTexture(unsigned int texId) { placeholder = texId; }
+    void setTextureShader(unsigned int texId, TextureShader shader);
+    void destroyTexture(unsigned int texId);
+
+    unsigned int createRenderTarget(int width, int height);
+    void renderToTarget(unsigned int target, const Quad* quads, const unsigned int* textureIds, size_t quadCount);
+    bool readPixels(unsigned int target, std::vector<uint8_t>& rgba, int& width, int& height);
+    void destroyRenderTarget(unsigned int target);
+
+    /// the last drawFrame()'s image: premultiplied RGBA8, top row first, device pixels
+    void readFrame(std::vector<uint8_t>& rgba, int& width, int& height) const;
+
+private:
+    struct Image {
+        int width = 0, height = 0;    // device pixels
+        int pointW = 0, pointH = 0;   // render targets: size in points
+        std::vector<uint8_t> rgba;
+        bool sdf = false;
+        bool reserved = false;        // drawn as the placeholder until its data arrives
+    };
+    struct Viewport {
+        int w = 0, h = 0;
+        float scale = 1.0f;
+    };
+
+    Viewport view;
+    std::unordered_map<unsigned int, Image> images;
+    unsigned int nextId = 1;
+    unsigned int placeholder = 0;
+    std::vector<std::pair<unsigned int, TextureUpload>> pending;
+    std::vector<Quad> quads;
+    std::vector<unsigned int> tex;
+    Image frame;
+
+    const Image* source(unsigned int texId) const;
+    void draw(Image& dst, float sx, float sy, const Quad* quads, const unsigned int* textureIds, size_t quadCount) const;
+    void triangle(Image& dst, const float* x, const float* y, const float* u, const float* v,
+                  const float (*color)[4], const Image& src) const;
+};
@@ -0,0 +1,138 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+// Display formatters named by "formatter" in the layout.  Each formatter is a
+// type with a static format(); the parameter table generator emits
+// &formatters::<name>::format straight from the JSON string, so
+// "Range<1,10>" is instantiated at compile time and a typo in the layout
+// is a build error instead of a runtime lookup failure.
+//
+// Everything here writes into a fixed buffer: no allocation, no locale,
+// no printf, so it's cheap enough to run at audio block rate for meters.
+
+struct FormattedText {
+    static constexpr int kCapacity = 16;
+    char text[kCapacity] = {};
+    uint8_t len = 0;
+
+    bool operator==(const FormattedText& o) const { return len == o.len && memcmp(text, o.text, len) == 0; }
+    bool operator!=(const FormattedText& o) const { return !(*this == o); }
+};
+
+/// value is exactly what the ParamStore holds for the param, never rescaled by
+/// the layout's "min"/"max".  Widgets store 0..1, so formatters that map onto a
+/// range (Range, valueToShapeString_unsafe) read it as normalized; the others
+/// print it as is, which suits values the processor publishes in plain units
+using FormatFn = void (*)(float value, FormattedText& out);
+
+namespace formatters {
+
+// integer to text, right to left into a scratch buffer, then copied out
+inline void appendInt(int v, FormattedText& out) {
+    char tmp[12];
+    int n = 0;
+    unsigned u = v < 0 ? 0u - (unsigned)v : (unsigned)v;
+    do { tmp[n++] = char('0' + u % 10); u /= 10; } while (u);
+    if (v < 0) tmp[n++] = '-';
+    while (n && out.len < FormattedText::kCapacity - 1) out.text[out.len++] = tmp[--n];
+    out.text[out.len] = 0;
+}
+
+inline void appendStr(const char* s, FormattedText& out) {
+    while (*s && out.len < FormattedText::kCapacity - 1) out.text[out.len++] = *s++;
+    out.text[out.len] = 0;
+}
+
+// nearest int to v, clamped to [lo, hi]; NaN gives lo.  Casting a NaN or an
+// out-of-range float straight to int is undefined behaviour
+inline int clampedRound(float v, int lo, int hi) {
+    if (!(v > float(lo))) return lo;   // also catches NaN
+    if (!(v < float(hi))) return hi;
+    return (int)std::lround(v);
+}
+
+// fixed-point float to text with Decimals digits after the point
+template <int Decimals>
+inline void appendFixed(float v, FormattedText& out) {
+    static_assert(Decimals >= 0 && Decimals <= 6, "appendFixed: 0..6 decimals");
+    constexpr int scale = Decimals == 0 ? 1 : Decimals == 1 ? 10 : Decimals == 2 ? 100 :
+                          Decimals == 3 ? 1000 : Decimals == 4 ? 10000 : Decimals == 5 ? 100000 : 1000000;
+    if (!std::isfinite(v)) { appendStr("---", out); return; }
+    bool neg = v < 0.0f;
+    const float mag = neg ? -v : v;
+    // clamped so both the long long and the int part below stay in range
+    long long fixed = (long long)((mag < 999999999.0f ? mag : 999999999.0f) * double(scale) + 0.5);
+    if (neg && fixed) appendStr("-", out);
+    appendInt(int(fixed / scale), out);
+    if (Decimals > 0) {
+        appendStr(".", out);
+        int frac = int(fixed % scale);
+        for (int d = scale / 10; d > 0 && out.len < FormattedText::kCapacity - 1; d /= 10)
+            out.text[out.len++] = char('0' + (frac / d) % 10);
+        out.text[out.len] = 0;
+    }
+}
+
+/// stored value shown as a rounded integer, e.g. a voice count from the processor
+struct intToString_unsafe {
+    static void format(float value, FormattedText& out) {
+        out.len = 0;
+        if (!std::isfinite(value)) { appendStr("---", out); return; }
+        appendInt(clampedRound(value, -999999999, 999999999), out);
+    }
+};
+
+/// normalized 0..1 mapped onto the integer range [Lo, Hi]; outside 0..1 clamps
+template <int Lo, int Hi>
+struct Range {
+    static_assert(Lo <= Hi, "Range<Lo,Hi>: Lo must not exceed Hi");
+    static void format(float value, FormattedText& out) {
+        out.len = 0;
+        if (!std::isfinite(value)) { appendStr("---", out); return; }
+        appendInt(Lo + clampedRound(value * float(Hi - Lo), 0, Hi - Lo), out);
+    }
+};
+
+/// stored value shown with a fixed number of decimals
+template <int Decimals>
+struct Fixed {
+    static void format(float value, FormattedText& out) {
+        out.len = 0;
+        appendFixed<Decimals>(value, out);
+    }
+};
+
+/// normalized 0..1 mapped onto the oscillator shapes; outside 0..1 clamps
+struct valueToShapeString_unsafe {
+    static constexpr const char* kShapes[] = { "sin", "saw", "sqr", "tri", "nse" };
+    static constexpr int kNumShapes = sizeof(kShapes) / sizeof(kShapes[0]);
+    static void format(float value, FormattedText& out) {
+        out.len = 0;
+        if (!std::isfinite(value)) { appendStr("---", out); return; }
+        appendStr(kShapes[clampedRound(value * float(kNumShapes - 1), 0, kNumShapes - 1)], out);
+    }
+};
+
+} // namespace formatters
+
+/// per-display cache: reformats only when the value moves, and reports
+/// a change only when the visible string differs, so text layout is skipped
+/// for the common case of a meter jittering inside one displayed digit
+struct CachedText {
+    FormatFn format = nullptr;
+    FormattedText text;
+    float lastValue = NAN;
+
+    /// returns true if text changed and the display needs re-laying out
+    bool update(float value) {
+        if (!format || value == lastValue) return false;
+        lastValue = value;
+        FormattedText next;
+        format(value, next);
+        if (next == text) return false;
+        text = next;
+        return true;
+    }
+};
@@ -1,8 +1,16 @@
 #include <png.h>
 #include "PlatformWindow_cocoa.h"
 #include "renderer.h"
+#include "param_store.h"
+#include "params_generated.h"
+#include "formatters.h"
+#include "text.h"
+#include "widget_table.h"
+#include "capture.h"
 
+#include <algorithm>
 #include <fstream>
+#include <unordered_map>
 inline Texture loadPNG(const char* filename) {
     FILE* fp = fopen(filename, "rb");
     if (!fp) throw std::runtime_error("Failed to open PNG");
@@ -47,97 +55,229 @@ inline Texture loadPNG(const char* filename) {
     return Texture(width, height, data);
 }
 
-struct Widget {
-    Widget( Renderer& renderer, std::string png, float x, float y ) { init( renderer, png, x, y ); }
-    void init( Renderer& renderer, std::string png, float x, float y ) {
-        tex = loadPNG(png.c_str());
-        texId = renderer.createTexture(tex);
-        quad.init( x, y, tex.width, tex.height );
+/// write premultiplied RGBA8 rows (e.g. Renderer::readPixels) as a straight-alpha PNG
+inline bool savePNG(const char* filename, const std::vector<uint8_t>& rgba, int width, int height) {
+    FILE* fp = fopen(filename, "wb");
+    if (!fp) return false;
+    png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    png_infop info = png_create_info_struct(png);
+    if (setjmp(png_jmpbuf(png))) {
+        png_destroy_write_struct(&png, &info);
+        fclose(fp);
+        return false;
     }
-    Texture tex;
-    unsigned int texId;
-    Quad quad;
-};
+    png_init_io(png, fp);
+    png_set_IHDR(png, info, width, height, 8, PNG_COLOR_TYPE_RGBA, PNG_INTERLACE_NONE,
+                 PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    png_write_info(png, info);
 
-#include <nlohmann/json.hpp>
-#include <fstream>
+    std::vector<uint8_t> row((size_t)width * 4);
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* src = &rgba[(size_t)y * width * 4];
+        for (int x = 0; x < width * 4; x += 4) {
+            const unsigned a = src[x + 3];
+            for (int c = 0; c < 3; ++c)
+                row[x + c] = a == 0 ? 0 : a == 255 ? src[x + c] : (uint8_t)std::min(255u, (src[x + c] * 255u + a / 2) / a);
+            row[x + 3] = (uint8_t)a;
+        }
+        png_write_row(png, row.data());
+    }
+    png_write_end(png, nullptr);
+    png_destroy_write_struct(&png, &info);
+    return fclose(fp) == 0;
+}
 
-using json = nlohmann::json;
+/// an input event for FrameCapture::event (core has no platform Event)
+inline CaptureEvent toCapture(const Event& e) {
+    CaptureEvent c;
+    c.type = (uint32_t)e.type;
+    c.x = e.x;
+    c.y = e.y;
+    c.width = e.width;
+    c.height = e.height;
+    c.key = e.key;
+    c.character = e.character;
+    c.keyRepeat = e.keyRepeat;
+    c.button = (uint32_t)e.button;
+    c.timeNs = e.timeNs;
+    return c;
+}
 
+/// values for label "text" keys that name a variable (e.g. "gVersionStr"); unknown names show as-is
+inline std::unordered_map<std::string, std::string>& textVariables() {
+    static std::unordered_map<std::string, std::string> vars;
+    return vars;
+}
 
+/// rings the processor writes, by the name meter/scope "source" keys use.
+/// register before loadGUI; a ring must outlive every table that reads it
+inline std::unordered_map<std::string, const SampleRing*>& signalSources() {
+    static std::unordered_map<std::string, const SampleRing*> sources;
+    return sources;
+}
 
-std::vector<Widget*> loadGUI(Renderer& renderer_context, const std::string& filename) {
-    std::vector<Widget*> widgets;  // local container, will be moved/returned
+// one slot per param in the generated table
+using GuiParamStore = ParamStore<kParamCount>;
 
-    std::ifstream f(filename);
-    if (!f.is_open()) {
-        printf("ERROR: could not open file '%s'\n", filename.c_str());
-        return widgets;
+/// seed the store with the layout defaults (e.g. when an editor opens)
+inline void initParamDefaults(GuiParamStore& store) {
+    for (uint32_t i = 0; i < kParamCount; ++i)
+        store.guiSet(i, kParamInfo[i].def);
+}
+
+#include "layout.h"
+
+inline TextBlock makeTextBlock(Renderer& renderer, const ControlDesc& ctrl) {
+    TextBlock tb;
+    tb.system = &textSystemFor(renderer);
+    tb.x = (float)ctrl.x;
+    tb.y = (float)ctrl.y;
+    tb.w = ctrl.hasSize ? (float)ctrl.w : 0.0f;
+    tb.h = ctrl.hasSize ? (float)ctrl.h : (float)kFontCellH;
+    tb.align = parseTextAlign(ctrl.align.empty() ? "center" : ctrl.align);
+    if (ctrl.textColor.set) tb.color = ctrl.textColor.value;
+    else if (ctrl.color.set) tb.color = ctrl.color.value;
+    if (ctrl.bgColor.set && !ctrl.transparent) {
+        tb.bgColor = ctrl.bgColor.value;
+        tb.hasBackground = true;
     }
+    return tb;
+}
 
-    json j;
-    try {
-        f >> j;
-    } catch (const nlohmann::json::parse_error& e) {
-        // e.byte gives the position in the input where the error occurred
-        std::string line_context;
-        try {
-            f.clear(); f.seekg(0);
-            std::string content((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
-            size_t pos = e.byte;
-            size_t start = (pos > 20) ? pos - 20 : 0;
-            size_t end = std::min(content.size(), pos + 20);
-            line_context = content.substr(start, end - start);
-        } catch (...) {
-            line_context = "(could not extract context)";
-        }
+/// "frames": N and "orientation": "vertical" | "horizontal" describe filmstrip art
+inline FilmstripOrientation parseOrientation(const ControlDesc& ctrl) {
+    return ctrl.orientation == "horizontal" ? FilmstripOrientation::Horizontal : FilmstripOrientation::Vertical;
+}
 
-        printf("JSON PARSE ERROR: %s\n at byte %zu, context: '%s'\n", e.what(), e.byte, line_context.c_str());
-        exit(-1);
-        return widgets;
-    } catch (const std::exception& e) {
-        printf("UNKNOWN ERROR parsing JSON: %s\n", e.what());
+
+
+inline LayoutAxis layoutAxis(int pos, float anchor, float size, float rel) {
+    LayoutAxis a;
+    a.anchor = anchor;
+    a.offset = (float)pos;
+    a.size = size;
+    a.rel = rel;
+    return a;
+}
+
+/// reloadAssets re-reads images from disk (e.g. the skin is being edited);
+/// otherwise textures already loaded by any window in the process are reused
+WidgetTable loadGUI(Renderer& renderer_context, const std::string& filename, bool reloadAssets = false) {
+    WidgetTable widgets;  // local container, will be moved/returned
+    TextureCache& textures = textureCacheFor(renderer_context); // controls sharing art share one upload
+    if (reloadAssets) textures.beginLoad(renderer_context);
+
+    LayoutDesc layout;
+    if (!loadLayout(filename, layout)) {
         exit(-1);
         return widgets;
     }
+    widgets.reserve(layout.controls.size());  // reserve capacity for efficiency
+    std::unordered_map<std::string_view, int32_t> groups; // "name" -> layout node
+    float designW = 0.0f, designH = 0.0f; // extent of the absolutely placed controls
+
+    for (size_t i = 0; i < layout.controls.size(); ++i) {
+        const ControlDesc& ctrl = layout.controls[i];
+        int32_t parent = -1;
+        if (!ctrl.parent.empty()) {
+            auto g = groups.find(ctrl.parent);
+            if (g != groups.end()) parent = g->second;
+            else printf("LAYOUT ERROR: control #%zu (label='%.*s') names unknown group '%.*s' (groups must come first); placed in the window\n",
+                        i, (int)ctrl.label.size(), ctrl.label.data(), (int)ctrl.parent.size(), ctrl.parent.data());
+        }
+
+        if (ctrl.type == "group") {
+            float w = ctrl.hasSize ? (float)ctrl.w : 0.0f, h = ctrl.hasSize ? (float)ctrl.h : 0.0f;
+            LayoutSpec spec{ layoutAxis(ctrl.x, ctrl.anchorX, w, ctrl.relW), layoutAxis(ctrl.y, ctrl.anchorY, h, ctrl.relH) };
+            int32_t node = widgets.layout.add(parent, spec, LayoutTree::kNoWidget);
+            if (!ctrl.name.empty()) groups[ctrl.name] = node;
+            continue;
+        }
 
-    auto& controls = j.at("controls");
-    widgets.reserve(controls.size());  // reserve capacity for efficiency
-
-    for (size_t i = 0; i < controls.size(); ++i) {
-        auto& ctrl = controls[i];
-        try {
-            std::string type    = ctrl.at("type");
-            int x               = ctrl.at("pos").at(0);
-            int y               = ctrl.at("pos").at(1);
-            std::string texture = ctrl.at("texture"); // this might throw
-            std::string label   = ctrl.value("label", "");
-
-            if (type == "background") {
-                widgets.emplace_back(new Widget(renderer_context, texture, x, y));
-            } else if (type == "knob") {
-                widgets.emplace_back(new Widget(renderer_context, texture, x, y));
-            } else if (type == "button") {
-                widgets.emplace_back(new Widget(renderer_context, texture, x, y));
-            } else if (type == "display") {
-                widgets.emplace_back(new Widget(renderer_context, texture, x, y));
-            } else if (type == "splash") {
-                widgets.emplace_back(new Widget(renderer_context, texture, x, y));
-            } else if (type == "kickButton") {
-                widgets.emplace_back(new Widget(renderer_context, texture, x, y));
-            } else {
-                printf("ERROR: unknown widget type: %s\n", type.c_str());
-                widgets.emplace_back(new Widget(renderer_context, texture, x, y));
+        WidgetType wtype = parseWidgetType(ctrl.type);
+        size_t index;
+
+        if (wtype == WidgetType::Display) {
+            index = widgets.addTextWidget(wtype, makeTextBlock(renderer_context, ctrl));
+        } else if (wtype == WidgetType::Label) {
+            index = widgets.addTextWidget(wtype, makeTextBlock(renderer_context, ctrl));
+            std::string text(ctrl.text);
+            auto var = textVariables().find(text);
+            widgets.textBlock(index)->setText(var != textVariables().end() ? var->second : text);
+        } else if (wtype == WidgetType::Meter || wtype == WidgetType::Scope) {
+            SignalView view;
+            view.system = &textSystemFor(renderer_context);
+            if (ctrl.window > 0) view.window = (uint32_t)ctrl.window;
+            if (ctrl.color.set) view.color = ctrl.color.value;
+            if (ctrl.bgColor.set && !ctrl.transparent) {
+                view.bgColor = ctrl.bgColor.value;
+                view.hasBackground = true;
+            }
+            auto src = signalSources().find(std::string(ctrl.source));
+            if (src != signalSources().end()) view.ring = src->second;
+            else printf("LAYOUT ERROR: widget #%zu (type='%.*s', label='%.*s') names unknown source '%.*s'; drawn empty\n", i,
+                        (int)ctrl.type.size(), ctrl.type.data(), (int)ctrl.label.size(), ctrl.label.data(),
+                        (int)ctrl.source.size(), ctrl.source.data());
+            float w = ctrl.hasSize ? (float)ctrl.w : 0.0f, h = ctrl.hasSize ? (float)ctrl.h : 0.0f;
+            index = widgets.addSignalWidget(wtype, ctrl.x, ctrl.y, w, h, std::move(view), parseOrientation(ctrl));
+        } else {
+            if (wtype == WidgetType::Unknown)
+                printf("ERROR: unknown widget type: %.*s\n", (int)ctrl.type.size(), ctrl.type.data());
+            // listbox art is its "bg_texture"; everything else names a "texture"
+            std::string_view texture = wtype == WidgetType::Listbox ? ctrl.bgTexture : ctrl.texture;
+            if (texture.empty()) {
+                printf("LAYOUT ERROR: widget #%zu (type='%.*s', label='%.*s') has no %s; skipped\n", i,
+                       (int)ctrl.type.size(), ctrl.type.data(), (int)ctrl.label.size(), ctrl.label.data(),
+                       wtype == WidgetType::Listbox ? "\"bg_texture\"" : "\"texture\"");
+                continue;
             }
-        } catch (const nlohmann::json::exception& e) {
-            std::string typeInfo = ctrl.value("type", "unknown");
-            std::string labelInfo = ctrl.value("label", "");
-            printf("JSON ERROR processing widget #%zu (type='%s', label='%s'): %s\n",
-                i, typeInfo.c_str(), labelInfo.c_str(), e.what());
+            const auto& tex = textures.get(renderer_context, std::string(texture), loadPNG);
+            index = widgets.addQuadWidget(wtype, ctrl.x, ctrl.y, tex.width, tex.height, tex.texId,
+                                          ctrl.frames, parseOrientation(ctrl));
+            if (tex.sdf && ctrl.color.set) widgets.colors[index] = ctrl.color.value; // a distance field is drawn in its tint
+        }
+
+        // art keeps its own size; with "rel_size" a quad stretches from "size" (or 0) instead
+        const WidgetRect& r = widgets.rects[index];
+        float w = r.w, h = r.h;
+        if (widgets.flags[index] & kWidgetHasQuad) {
+            if (ctrl.relW != 0.0f) w = ctrl.hasSize ? (float)ctrl.w : 0.0f;
+            if (ctrl.relH != 0.0f) h = ctrl.hasSize ? (float)ctrl.h : 0.0f;
+        }
+        LayoutSpec spec{ layoutAxis(ctrl.x, ctrl.anchorX, w, ctrl.relW), layoutAxis(ctrl.y, ctrl.anchorY, h, ctrl.relH) };
+        widgets.layout.add(parent, spec, (int32_t)index);
+        if (parent < 0 && ctrl.anchorX == 0.0f && ctrl.anchorY == 0.0f && ctrl.relW == 0.0f && ctrl.relH == 0.0f) {
+            designW = std::max(designW, r.x + r.w);
+            designH = std::max(designH, r.y + r.h);
+        }
+
+        if (wtype == WidgetType::Splash) {
+            widgets.timeoutsMs[index] = ctrl.timeout > 0 ? (uint32_t)ctrl.timeout : 0;
+            widgets.setAlpha(index, 0.0f); // hidden until its param turns it on
+        }
+
+        if (!ctrl.param.empty()) {
+            int id = paramIdFromName(ctrl.param);
+            widgets.bindParam(index, id);
+            if (wtype == WidgetType::Display && id >= 0)
+                widgets.cachedText(index)->format = kParamInfo[id].format;
         }
     }
 
-    return widgets; // NRVO or move constructor of std::vector
+    // place everything once at the size the layout was drawn for; the host
+    // calls widgets.resize() with the real window size from then on
+    widgets.layout.finalize();
+    widgets.resize(designW, designH);
+
+    if (textures.gpuBytes < textures.rgbaBytes)
+        printf("textures: %zu KiB in VRAM, %zu KiB saved by compression\n",
+               textures.gpuBytes / 1024, (textures.rgbaBytes - textures.gpuBytes) / 1024);
+    const int windows = renderer_context.shareGroupSize();
+    if (windows > 1)
+        printf("textures: %zu KiB shared by %d windows, %zu KiB saved vs. one copy per window\n",
+               textures.gpuBytes / 1024, windows, textures.gpuBytes * (windows - 1) / 1024);
+
+    return widgets; // NRVO or move constructor of WidgetTable
 }
 
 
@@ -0,0 +1,220 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+
+// Single-pass pull parser for the layout file.  It walks a mutable buffer
+// once, without building a DOM: strings come back as views into the buffer
+// (escapes are decoded in place), numbers are parsed on the spot, and
+// anything the caller doesn't ask for is skipped.  Errors don't throw: the
+// first one is recorded with its line/column and every later call returns
+// false, so a loader can just check ok() at the points it cares about.
+//
+//   JsonReader r(buf, len);
+//   if (r.beginObject())
+//       for (std::string_view key; r.nextKey(key);)
+//           if (key == "pos") ... else r.skipValue();
+
+enum class JsonType { Null, Boolean, Number, String, Array, Object, End, Invalid };
+
+class JsonReader {
+public:
+    JsonReader(char* text, size_t length) : p(text), begin(text), end(text + length) {}
+
+    bool ok() const { return !errorMsg; }
+    const char* error() const { return errorMsg; }
+    int errorLine() const { return line; }
+    int errorColumn() const { return column; }
+
+    /// record an error at the current position (e.g. a schema violation); the first one wins
+    bool fail(const char* message) {
+        if (errorMsg) return false;
+        errorMsg = message;
+        line = 1;
+        const char* lineStart = begin;
+        for (const char* c = begin; c < p && c < end; ++c)
+            if (*c == '\n') { ++line; lineStart = c + 1; }
+        column = (int)(p - lineStart) + 1;
+        return false;
+    }
+
+    JsonType peek() {
+        if (errorMsg) return JsonType::Invalid;
+        skipSpace();
+        if (p >= end) return JsonType::End;
+        switch (*p) {
+        case '{': return JsonType::Object;
+        case '[': return JsonType::Array;
+        case '"': return JsonType::String;
+        case 't': case 'f': return JsonType::Boolean;
+        case 'n': return JsonType::Null;
+        default: return (*p == '-' || (*p >= '0' && *p <= '9')) ? JsonType::Number : JsonType::Invalid;
+        }
+    }
+
+    bool beginObject() { return expect('{', "expected '{'") && (first = true); }
+    bool beginArray() { return expect('[', "expected '['") && (first = true); }
+
+    /// next member of the current object; false at its '}' (or on error)
+    bool nextKey(std::string_view& key) {
+        if (!nextItem('}')) return false;
+        return readString(key) && expect(':', "expected ':' after key");
+    }
+
+    /// step to the next element of the current array; false at its ']' (or on error)
+    bool nextElement() { return nextItem(']'); }
+
+    bool readString(std::string_view& out) {
+        if (!expect('"', "expected a string")) return false;
+        char* start = p;
+        char* w = p; // write head for decoded escapes; never passes p
+        while (p < end && *p != '"') {
+            if ((unsigned char)*p < 0x20) return fail("control character in string");
+            if (*p != '\\') { *w++ = *p++; continue; }
+            if (++p >= end) break;
+            switch (*p++) {
+            case '"': *w++ = '"'; break;
+            case '\\': *w++ = '\\'; break;
+            case '/': *w++ = '/'; break;
+            case 'b': *w++ = '\b'; break;
+            case 'f': *w++ = '\f'; break;
+            case 'n': *w++ = '\n'; break;
+            case 'r': *w++ = '\r'; break;
+            case 't': *w++ = '\t'; break;
+            case 'u': {
+                uint32_t cp = 0;
+                if (!readHex4(cp)) return false;
+                if (cp >= 0xD800 && cp <= 0xDBFF) { // surrogate pair
+                    uint32_t lo = 0;
+                    if (end - p < 2 || p[0] != '\\' || p[1] != 'u') return fail("unpaired surrogate in string");
+                    p += 2;
+                    if (!readHex4(lo)) return false;
+                    if (lo < 0xDC00 || lo > 0xDFFF) return fail("unpaired surrogate in string");
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                }
+                w = putUtf8(w, cp); // at most 4 bytes for the 6-12 just read
+                break;
+            }
+            default: return fail("bad escape in string");
+            }
+        }
+        if (p >= end) return fail("unterminated string");
+        ++p; // closing quote
+        out = std::string_view(start, (size_t)(w - start));
+        return true;
+    }
+
+    bool readNumber(double& out) {
+        skipSpace();
+        const char* start = p;
+        if (p < end && *p == '-') ++p;
+        if (p >= end || *p < '0' || *p > '9') { p = const_cast<char*>(start); return fail("expected a number"); }
+        while (p < end && ((*p >= '0' && *p <= '9') || *p == '.' || *p == 'e' || *p == 'E' || *p == '+' || *p == '-')) ++p;
+        // strtod needs a terminator; the buffer might not have one right here
+        char tmp[64];
+        size_t n = (size_t)(p - start);
+        if (n >= sizeof(tmp)) return fail("number too long");
+        for (size_t i = 0; i < n; ++i) tmp[i] = start[i];
+        tmp[n] = 0;
+        char* parsed = nullptr;
+        out = strtod(tmp, &parsed);
+        if (parsed != tmp + n) { p = const_cast<char*>(start); return fail("malformed number"); }
+        return true;
+    }
+
+    bool readInt(int& out) {
+        double d = 0;
+        if (!readNumber(d)) return false;
+        if (d < -2147483648.0 || d > 2147483647.0) return fail("number out of range");
+        out = (int)d;
+        return true;
+    }
+
+    bool readBool(bool& out) {
+        skipSpace();
+        if (matchWord("true")) { out = true; return true; }
+        if (matchWord("false")) { out = false; return true; }
+        return fail("expected true or false");
+    }
+
+    /// skip one value of any type, nested containers included
+    bool skipValue() {
+        switch (peek()) {
+        case JsonType::Object: {
+            beginObject();
+            for (std::string_view key; nextKey(key);) skipValue();
+            return ok();
+        }
+        case JsonType::Array:
+            beginArray();
+            while (nextElement()) skipValue();
+            return ok();
+        case JsonType::String: { std::string_view s; return readString(s); }
+        case JsonType::Number: { double d; return readNumber(d); }
+        case JsonType::Boolean: { bool b; return readBool(b); }
+        case JsonType::Null: return matchWord("null") || fail("expected null");
+        case JsonType::End: return fail("unexpected end of file");
+        default: return fail("unexpected character");
+        }
+    }
+
+    /// nothing but whitespace left
+    bool atEnd() { skipSpace(); return p >= end || fail("trailing characters after the document"); }
+
+private:
+    char* p;
+    const char* begin;
+    const char* end;
+    bool first = false; // no ',' expected before the next item
+    const char* errorMsg = nullptr;
+    int line = 0, column = 0;
+
+    void skipSpace() {
+        while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) ++p;
+    }
+
+    bool expect(char c, const char* message) {
+        if (errorMsg) return false;
+        skipSpace();
+        if (p >= end || *p != c) return fail(message);
+        ++p;
+        return true;
+    }
+
+    bool nextItem(char close) {
+        if (errorMsg) return false;
+        skipSpace();
+        if (p < end && *p == close) { ++p; first = false; return false; }
+        if (!first && !expect(',', close == '}' ? "expected ',' or '}'" : "expected ',' or ']'")) return false;
+        first = false;
+        return true;
+    }
+
+    bool matchWord(const char* word) {
+        const char* q = p;
+        for (; *word; ++word, ++q)
+            if (q >= end || *q != *word) return false;
+        p = const_cast<char*>(q);
+        return true;
+    }
+
+    bool readHex4(uint32_t& out) {
+        if (end - p < 4) return fail("bad \\u escape");
+        for (int i = 0; i < 4; ++i, ++p) {
+            char c = *p;
+            uint32_t v = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : 16;
+            if (v > 15) return fail("bad \\u escape");
+            out = out * 16 + v;
+        }
+        return true;
+    }
+
+    static char* putUtf8(char* w, uint32_t cp) {
+        if (cp < 0x80) { *w++ = (char)cp; }
+        else if (cp < 0x800) { *w++ = (char)(0xC0 | (cp >> 6)); *w++ = (char)(0x80 | (cp & 0x3F)); }
+        else if (cp < 0x10000) { *w++ = (char)(0xE0 | (cp >> 12)); *w++ = (char)(0x80 | ((cp >> 6) & 0x3F)); *w++ = (char)(0x80 | (cp & 0x3F)); }
+        else { *w++ = (char)(0xF0 | (cp >> 18)); *w++ = (char)(0x80 | ((cp >> 12) & 0x3F)); *w++ = (char)(0x80 | ((cp >> 6) & 0x3F)); *w++ = (char)(0x80 | (cp & 0x3F)); }
+        return w;
+    }
+};
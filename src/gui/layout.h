@@ -0,0 +1,481 @@
+#pragma once
+#include "json_reader.h"
+#include "text.h" // packColor
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#if defined(__APPLE__) || defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// The layout as plain records, before any widget exists.  It comes from one
+// of two files kept side by side:
+//
+//   def.json        the source of truth, edited by hand
+//   def.layout.bin  the same controls, pre-parsed: fixed-size records plus a
+//                   string table, mapped and used in place
+//
+// The binary carries the format version plus the size, mtime and hash of the
+// JSON it was made from.  loadLayout() takes it when the JSON's size and
+// mtime still match (hashing only if they don't, e.g. after an installer
+// touched the files), or when there is no JSON next to it at all.  Otherwise
+// it parses the JSON and rewrites the binary, so editing def.json is all it
+// takes.
+//
+// Besides the absolute "pos", a control may be placed relative to a group or
+// the window (see layout_tree.h):
+//
+//   "name": "env"                 a "group" other controls can name as parent
+//   "parent": "env"               pos/anchor are then relative to that group
+//   "anchor": "bottom-right"      or [ax, ay] in 0..1; default top-left
+//   "rel_size": [1.0, 0.5]        fraction of the parent added to "size"
+//
+// "meter" and "scope" controls draw a live signal instead of art:
+//
+//   "source": "out"               a ring registered in signalSources()
+//   "window": 2048                scope only: samples shown across its width
+
+/// a "color" value: [r,g,b(,a)] or the name of an entry in "colors"
+struct ColorRef {
+    std::string_view name; // unresolved name (JSON only, cleared by resolve)
+    uint32_t value = 0;    // packColor
+    bool set = false;
+};
+
+/// one entry of "controls"; views point into LayoutDesc::storage
+struct ControlDesc {
+    std::string_view type, label, param, text;
+    std::string_view texture, bgTexture;
+    std::string_view align, orientation;
+    std::string_view name, parent;
+    std::string_view source; // meter/scope: signalSources() name
+    int x = 0, y = 0;
+    int w = 0, h = 0;
+    bool hasSize = false;
+    bool transparent = false;
+    int frames = 1;
+    int timeout = 0; // ms, splash only
+    int window = 0;  // scope: samples across its width, 0 = default
+    float anchorX = 0.0f, anchorY = 0.0f;
+    float relW = 0.0f, relH = 0.0f;
+    ColorRef textColor, color, bgColor;
+};
+
+struct LayoutDesc {
+    std::vector<ControlDesc> controls;
+    std::shared_ptr<void> storage; // file bytes the views point into
+};
+
+namespace layout_detail {
+
+inline uint64_t fnv1a(const char* data, size_t n) {
+    uint64_t h = 1469598103934665603ull;
+    for (size_t i = 0; i < n; ++i) { h ^= (unsigned char)data[i]; h *= 1099511628211ull; }
+    return h;
+}
+
+// ---- JSON ----
+
+inline bool readColor(JsonReader& r, ColorRef& c) {
+    if (r.peek() == JsonType::String) {
+        c.set = r.readString(c.name);
+        return c.set;
+    }
+    int ch[4] = { 0, 0, 0, 255 };
+    int n = 0;
+    if (!r.beginArray()) return false;
+    while (r.nextElement()) {
+        if (n == 4) return r.fail("a color has at most 4 channels");
+        if (!r.readInt(ch[n])) return false;
+        if (ch[n] < 0 || ch[n] > 255) return r.fail("color channels are 0..255");
+        ++n;
+    }
+    if (!r.ok()) return false;
+    if (n < 3) return true; // too short: ignored, the widget keeps its default
+    c.value = packColor(ch[0], ch[1], ch[2], ch[3]);
+    c.set = true;
+    return true;
+}
+
+// "pos": [x, y] / "size": [w, h]
+inline bool readPair(JsonReader& r, int& a, int& b) {
+    if (!r.beginArray()) return false;
+    if (!r.nextElement()) return r.fail("expected two numbers");
+    if (!r.readInt(a)) return false;
+    if (!r.nextElement()) return r.fail("expected two numbers");
+    if (!r.readInt(b)) return false;
+    if (r.nextElement()) return r.fail("expected two numbers");
+    return r.ok();
+}
+
+// "rel_size": [fw, fh]
+inline bool readFloatPair(JsonReader& r, float& a, float& b) {
+    double da = 0, db = 0;
+    if (!r.beginArray()) return false;
+    if (!r.nextElement()) return r.fail("expected two numbers");
+    if (!r.readNumber(da)) return false;
+    if (!r.nextElement()) return r.fail("expected two numbers");
+    if (!r.readNumber(db)) return false;
+    if (r.nextElement()) return r.fail("expected two numbers");
+    a = (float)da;
+    b = (float)db;
+    return r.ok();
+}
+
+// "anchor": "top-left" ... "bottom-right", "top", "left", "center", or [ax, ay]
+inline bool readAnchor(JsonReader& r, float& ax, float& ay) {
+    if (r.peek() != JsonType::String) return readFloatPair(r, ax, ay);
+    std::string_view s;
+    if (!r.readString(s)) return false;
+    // "<vertical>-<horizontal>", or either half on its own
+    std::string_view v, h = s;
+    size_t dash = s.find('-');
+    if (dash != std::string_view::npos) { v = s.substr(0, dash); h = s.substr(dash + 1); }
+    else if (s == "top" || s == "bottom") { v = s; h = {}; }
+    ax = ay = 0.5f;
+    if (v == "top") ay = 0.0f;
+    else if (v == "bottom") ay = 1.0f;
+    else if (!v.empty()) return r.fail("unknown anchor");
+    if (h == "left") ax = 0.0f;
+    else if (h == "right") ax = 1.0f;
+    else if (!h.empty() && h != "center") return r.fail("unknown anchor");
+    return true;
+}
+
+inline bool readControl(JsonReader& r, ControlDesc& c, bool& hasType, bool& hasPos) {
+    if (!r.beginObject()) return false;
+    for (std::string_view key; r.nextKey(key);) {
+        bool ok;
+        if (key == "type") ok = hasType = r.readString(c.type);
+        else if (key == "pos") ok = hasPos = readPair(r, c.x, c.y);
+        else if (key == "size") ok = c.hasSize = readPair(r, c.w, c.h);
+        else if (key == "label") ok = r.readString(c.label);
+        else if (key == "param") ok = r.readString(c.param);
+        else if (key == "text") ok = r.readString(c.text);
+        else if (key == "texture") ok = r.readString(c.texture);
+        else if (key == "bg_texture") ok = r.readString(c.bgTexture);
+        else if (key == "align") ok = r.readString(c.align);
+        else if (key == "orientation") ok = r.readString(c.orientation);
+        else if (key == "frames") ok = r.readInt(c.frames);
+        else if (key == "timeout") ok = r.readInt(c.timeout);
+        else if (key == "source") ok = r.readString(c.source);
+        else if (key == "window") ok = r.readInt(c.window);
+        else if (key == "name") ok = r.readString(c.name);
+        else if (key == "parent") ok = r.readString(c.parent);
+        else if (key == "anchor") ok = readAnchor(r, c.anchorX, c.anchorY);
+        else if (key == "rel_size") ok = readFloatPair(r, c.relW, c.relH);
+        else if (key == "transparent") ok = r.readBool(c.transparent);
+        else if (key == "text_color") ok = readColor(r, c.textColor);
+        else if (key == "color") ok = readColor(r, c.color);
+        else if (key == "bg_color") ok = readColor(r, c.bgColor);
+        else ok = r.skipValue(); // e.g. "min"/"max"/"formatter", read by gen_params.cmake
+        if (!ok) return false;
+    }
+    return r.ok();
+}
+
+struct NamedColor { std::string_view name; ColorRef color; };
+
+inline void resolve(ColorRef& c, const std::vector<NamedColor>& colors) {
+    if (c.name.empty()) return;
+    for (const NamedColor& nc : colors) {
+        if (nc.name == c.name) { c = nc.color; return; }
+    }
+    printf("ERROR: unknown color: %.*s\n", (int)c.name.size(), c.name.data());
+    c = ColorRef{};
+}
+
+// ---- binary ----
+
+constexpr char kMagic[4] = { 'S', 'G', 'L', 'B' };
+constexpr uint32_t kVersion = 4; // bump with any change to the records below
+
+// the JSON a binary was built from
+struct SourceStamp {
+    uint64_t size;
+    int64_t mtime; // filesystem clock ticks
+    uint64_t hash; // fnv1a of the bytes
+};
+
+struct BinHeader {
+    char magic[4];
+    uint32_t version;
+    SourceStamp source;
+    uint32_t controlCount;
+    uint32_t stringBytes;
+};
+
+struct BinString { uint32_t offset, length; };
+
+struct BinColor { uint32_t value, set; };
+
+struct BinControl {
+    BinString type, label, param, text;
+    BinString texture, bgTexture;
+    BinString align, orientation;
+    BinString name, parent, source;
+    int32_t x, y, w, h;
+    int32_t frames;
+    int32_t timeout;
+    int32_t window;
+    uint32_t flags; // kHasSize | kTransparent
+    float anchorX, anchorY, relW, relH;
+    BinColor textColor, color, bgColor;
+};
+constexpr uint32_t kHasSize = 1, kTransparent = 2;
+
+static_assert(sizeof(BinHeader) == 40, "layout binary header must stay packed");
+static_assert(sizeof(BinControl) == 160, "layout binary record must stay packed");
+
+inline std::string layoutBinaryPath(const std::string& jsonPath) {
+    size_t dot = jsonPath.rfind('.');
+    return (dot == std::string::npos ? jsonPath : jsonPath.substr(0, dot)) + ".layout.bin";
+}
+
+/// whole file, read-only; mapped where the platform can
+inline std::shared_ptr<void> mapFile(const std::string& path, size_t& size) {
+#if defined(__APPLE__) || defined(__linux__)
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat st;
+    void* addr = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+        addr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) return nullptr;
+    size = (size_t)st.st_size;
+    return std::shared_ptr<void>(addr, [size](void* a) { munmap(a, size); });
+#else
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (!fp) return nullptr;
+    fseek(fp, 0, SEEK_END);
+    long n = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    std::shared_ptr<char> buf(new char[n > 0 ? n : 1], std::default_delete<char[]>());
+    size = n > 0 && fread(buf.get(), 1, (size_t)n, fp) == (size_t)n ? (size_t)n : 0;
+    fclose(fp);
+    return size ? buf : nullptr;
+#endif
+}
+
+/// isCurrent(const SourceStamp&) decides whether the binary still matches its JSON
+template <typename IsCurrent>
+bool readBinary(const std::string& path, IsCurrent&& isCurrent, LayoutDesc& out) {
+    size_t size = 0;
+    std::shared_ptr<void> file = mapFile(path, size);
+    if (!file || size < sizeof(BinHeader)) return false;
+    const char* base = static_cast<const char*>(file.get());
+    BinHeader h;
+    memcpy(&h, base, sizeof(h));
+    if (memcmp(h.magic, kMagic, 4) != 0 || h.version != kVersion) return false;
+    if (!isCurrent(h.source)) return false;
+    if (size != sizeof(BinHeader) + (size_t)h.controlCount * sizeof(BinControl) + h.stringBytes) {
+        printf("ERROR: %s is truncated or corrupt\n", path.c_str());
+        return false;
+    }
+
+    const BinControl* recs = reinterpret_cast<const BinControl*>(base + sizeof(BinHeader));
+    const char* strings = base + sizeof(BinHeader) + (size_t)h.controlCount * sizeof(BinControl);
+    bool valid = true;
+    auto str = [&](BinString s) {
+        if ((uint64_t)s.offset + s.length > h.stringBytes) { valid = false; return std::string_view(); }
+        return std::string_view(strings + s.offset, s.length);
+    };
+    auto color = [](BinColor c) { ColorRef r; r.value = c.value; r.set = c.set != 0; return r; };
+
+    out.controls.clear();
+    out.controls.reserve(h.controlCount);
+    for (uint32_t i = 0; i < h.controlCount; ++i) {
+        const BinControl& b = recs[i];
+        ControlDesc c;
+        c.type = str(b.type); c.label = str(b.label); c.param = str(b.param); c.text = str(b.text);
+        c.texture = str(b.texture); c.bgTexture = str(b.bgTexture);
+        c.align = str(b.align); c.orientation = str(b.orientation);
+        c.name = str(b.name); c.parent = str(b.parent); c.source = str(b.source);
+        c.x = b.x; c.y = b.y; c.w = b.w; c.h = b.h;
+        c.frames = b.frames;
+        c.timeout = b.timeout;
+        c.window = b.window;
+        c.hasSize = (b.flags & kHasSize) != 0;
+        c.transparent = (b.flags & kTransparent) != 0;
+        c.anchorX = b.anchorX; c.anchorY = b.anchorY; c.relW = b.relW; c.relH = b.relH;
+        c.textColor = color(b.textColor); c.color = color(b.color); c.bgColor = color(b.bgColor);
+        out.controls.push_back(c);
+    }
+    if (!valid) {
+        printf("ERROR: %s has string offsets past its string table\n", path.c_str());
+        out.controls.clear();
+        return false;
+    }
+    out.storage = std::move(file);
+    return true;
+}
+
+inline bool writeBinary(const std::string& path, const SourceStamp& source, const LayoutDesc& layout) {
+    std::string strings;
+    auto str = [&strings](std::string_view s) {
+        BinString b{ (uint32_t)strings.size(), (uint32_t)s.size() };
+        strings.append(s.data(), s.size());
+        return b;
+    };
+    auto color = [](const ColorRef& c) { return BinColor{ c.value, c.set ? 1u : 0u }; };
+
+    std::vector<BinControl> recs;
+    recs.reserve(layout.controls.size());
+    for (const ControlDesc& c : layout.controls) {
+        BinControl b{};
+        b.type = str(c.type); b.label = str(c.label); b.param = str(c.param); b.text = str(c.text);
+        b.texture = str(c.texture); b.bgTexture = str(c.bgTexture);
+        b.align = str(c.align); b.orientation = str(c.orientation);
+        b.name = str(c.name); b.parent = str(c.parent); b.source = str(c.source);
+        b.x = c.x; b.y = c.y; b.w = c.w; b.h = c.h;
+        b.frames = c.frames;
+        b.timeout = c.timeout;
+        b.window = c.window;
+        b.flags = (c.hasSize ? kHasSize : 0) | (c.transparent ? kTransparent : 0);
+        b.anchorX = c.anchorX; b.anchorY = c.anchorY; b.relW = c.relW; b.relH = c.relH;
+        b.textColor = color(c.textColor); b.color = color(c.color); b.bgColor = color(c.bgColor);
+        recs.push_back(b);
+    }
+
+    BinHeader h{};
+    memcpy(h.magic, kMagic, 4);
+    h.version = kVersion;
+    h.source = source;
+    h.controlCount = (uint32_t)recs.size();
+    h.stringBytes = (uint32_t)strings.size();
+
+    // write to a temp name and rename, so another process never maps half a file
+    std::string tmp = path + ".tmp";
+    FILE* fp = fopen(tmp.c_str(), "wb");
+    if (!fp) return false;
+    bool ok = fwrite(&h, sizeof(h), 1, fp) == 1 &&
+              (recs.empty() || fwrite(recs.data(), sizeof(BinControl), recs.size(), fp) == recs.size()) &&
+              fwrite(strings.data(), 1, strings.size(), fp) == strings.size();
+    ok = fclose(fp) == 0 && ok;
+    if (ok) ok = rename(tmp.c_str(), path.c_str()) == 0;
+    if (!ok) remove(tmp.c_str());
+    return ok;
+}
+
+} // namespace layout_detail
+
+/// parse layout JSON in place (text is modified: escapes are decoded into it).
+/// syntax and schema errors print with line:column and return false; a
+/// control missing "type" or "pos" is reported and left out
+inline bool parseLayoutJson(char* text, size_t length, LayoutDesc& out, const char* filename = "layout") {
+    using namespace layout_detail;
+    JsonReader r(text, length);
+    std::vector<NamedColor> colors;
+    out.controls.clear();
+
+    if (r.beginObject()) {
+        for (std::string_view key; r.nextKey(key);) {
+            if (key == "colors") {
+                if (!r.beginObject()) break;
+                for (std::string_view name; r.nextKey(name);) {
+                    NamedColor nc{ name, {} };
+                    if (r.peek() == JsonType::String) { r.fail("a named color must be [r,g,b(,a)]"); break; }
+                    if (!readColor(r, nc.color)) break;
+                    colors.push_back(nc);
+                }
+            } else if (key == "controls") {
+                if (!r.beginArray()) break;
+                while (r.nextElement()) {
+                    ControlDesc c;
+                    bool hasType = false, hasPos = false;
+                    if (!readControl(r, c, hasType, hasPos)) break;
+                    if (!hasType || !hasPos) {
+                        printf("LAYOUT ERROR: %s: control #%zu (label='%.*s') needs \"type\" and \"pos\"; skipped\n",
+                               filename, out.controls.size(), (int)c.label.size(), c.label.data());
+                        continue;
+                    }
+                    out.controls.push_back(c);
+                }
+            } else {
+                r.skipValue();
+            }
+            if (!r.ok()) break;
+        }
+    }
+    if (r.ok()) r.atEnd();
+    if (!r.ok()) {
+        printf("LAYOUT PARSE ERROR: %s:%d:%d: %s\n", filename, r.errorLine(), r.errorColumn(), r.error());
+        out.controls.clear();
+        return false;
+    }
+
+    for (ControlDesc& c : out.controls) {
+        resolve(c.textColor, colors);
+        resolve(c.color, colors);
+        resolve(c.bgColor, colors);
+    }
+    return true;
+}
+
+/// def.layout.bin if it is current, else def.json (refreshing the binary).
+/// prints which one was used and how long loading took
+inline bool loadLayout(const std::string& jsonPath, LayoutDesc& out) {
+    using namespace layout_detail;
+    using clock = std::chrono::steady_clock;
+    auto t0 = clock::now();
+    auto ms = [&t0]() { return std::chrono::duration<double, std::milli>(clock::now() - t0).count(); };
+    const std::string binPath = layoutBinaryPath(jsonPath);
+
+    std::error_code ec;
+    SourceStamp stamp{ 0, 0, 0 };
+    stamp.size = (uint64_t)std::filesystem::file_size(jsonPath, ec);
+    if (ec) {
+        if (readBinary(binPath, [](const SourceStamp&) { return true; }, out)) {
+            printf("layout: %s (no JSON next to it), %zu controls in %.3f ms\n", binPath.c_str(), out.controls.size(), ms());
+            return true;
+        }
+        printf("ERROR: could not open file '%s'\n", jsonPath.c_str());
+        return false;
+    }
+    stamp.mtime = (int64_t)std::filesystem::last_write_time(jsonPath, ec).time_since_epoch().count();
+
+    size_t size = 0;
+    std::shared_ptr<void> json; // only read if the stamp alone can't tell
+    auto hashJson = [&]() {
+        if (!json) json = mapFile(jsonPath, size);
+        return json ? fnv1a(static_cast<const char*>(json.get()), size) : 0;
+    };
+    auto isCurrent = [&](const SourceStamp& s) {
+        if (s.size != stamp.size) return false;
+        return s.mtime == stamp.mtime || s.hash == hashJson();
+    };
+    if (readBinary(binPath, isCurrent, out)) {
+        printf("layout: %s, %zu controls in %.3f ms\n", binPath.c_str(), out.controls.size(), ms());
+        return true;
+    }
+
+    if (!json) json = mapFile(jsonPath, size);
+    if (!json) {
+        printf("ERROR: could not open file '%s'\n", jsonPath.c_str());
+        return false;
+    }
+    stamp.size = size;
+    stamp.hash = hashJson();
+    // the parser decodes in place, so it needs its own copy of the mapped text
+    std::shared_ptr<char> text(new char[size], std::default_delete<char[]>());
+    memcpy(text.get(), json.get(), size);
+    json.reset();
+    if (!parseLayoutJson(text.get(), size, out, jsonPath.c_str())) return false;
+    out.storage = text;
+    printf("layout: %s, %zu controls in %.3f ms\n", jsonPath.c_str(), out.controls.size(), ms());
+
+    if (!writeBinary(binPath, stamp, out))
+        printf("NOTE: could not write %s; the JSON will be parsed every time\n", binPath.c_str());
+    return true;
+}
@@ -0,0 +1,173 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Relative layout: every node is placed inside its parent (a group, or the
+// window) by an anchor, an offset and a size that may be a fraction of the
+// parent's.  Per axis:
+//
+//   size = fixed + rel * parentSize
+//   pos  = parentPos + anchor * (parentSize - size) + offset
+//
+// so anchor 0 keeps the offset from the parent's left/top edge (what an
+// absolute "pos" always meant), 1 from its right/bottom edge, 0.5 centers.
+//
+// Nodes are kept in pre-order, each with the end of its subtree, in flat
+// arrays.  update() walks them once and recomputes only what can have
+// changed: nodes whose spec was edited and children of nodes that actually
+// moved.  A subtree whose root comes out where it was is skipped whole, so a
+// window drag only touches the right/bottom-anchored parts of a panel.
+
+struct WidgetRect { float x, y, w, h; };
+
+inline bool operator==(const WidgetRect& a, const WidgetRect& b) {
+    return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
+}
+inline bool operator!=(const WidgetRect& a, const WidgetRect& b) { return !(a == b); }
+
+struct LayoutAxis {
+    float anchor = 0.0f; // 0 start, 0.5 center, 1 end of the parent
+    float offset = 0.0f; // points
+    float size = 0.0f;   // points
+    float rel = 0.0f;    // fraction of the parent's size, added to size
+};
+
+struct LayoutSpec {
+    LayoutAxis x, y;
+};
+
+class LayoutTree {
+public:
+    static constexpr int32_t kNoWidget = -1;
+
+    /// parent is a node index returned earlier, or -1 for the window.
+    /// nodes may be added in any order; finalize() sorts them
+    int32_t add(int32_t parent, const LayoutSpec& spec, int32_t widget) {
+        addParents.push_back(parent);
+        addSpecs.push_back(spec);
+        addWidgets.push_back(widget);
+        return (int32_t)addParents.size() - 1;
+    }
+
+    /// put the added nodes in pre-order (siblings keep their order); call once after the last add()
+    void finalize() {
+        const int32_t n = (int32_t)addParents.size();
+        std::vector<int32_t> firstChild(n, -1), nextSibling(n, -1), lastChild(n, -1);
+        int32_t firstRoot = -1, lastRoot = -1;
+        for (int32_t i = 0; i < n; ++i) {
+            int32_t p = addParents[i];
+            int32_t& last = p < 0 ? lastRoot : lastChild[p];
+            if (last < 0) (p < 0 ? firstRoot : firstChild[p]) = i;
+            else nextSibling[last] = i;
+            last = i;
+        }
+
+        std::vector<int32_t> newIndex(n, -1);
+        parents.clear(); specs.clear(); widgets.clear(); subtreeEnd.assign(n, 0);
+        parents.reserve(n); specs.reserve(n); widgets.reserve(n);
+        std::vector<int32_t> stack;
+        for (int32_t root = firstRoot; root >= 0; root = nextSibling[root]) {
+            stack.push_back(root);
+            while (!stack.empty()) {
+                int32_t i = stack.back();
+                if (newIndex[i] >= 0) { // children done
+                    subtreeEnd[newIndex[i]] = (uint32_t)parents.size();
+                    stack.pop_back();
+                    continue;
+                }
+                newIndex[i] = (int32_t)parents.size();
+                parents.push_back(addParents[i] < 0 ? -1 : newIndex[addParents[i]]);
+                specs.push_back(addSpecs[i]);
+                widgets.push_back(addWidgets[i]);
+                // push children in reverse so the first one comes out first
+                size_t mark = stack.size();
+                for (int32_t c = firstChild[i]; c >= 0; c = nextSibling[c]) stack.push_back(c);
+                for (size_t a = mark, b = stack.size() - 1; a < b; ++a, --b) std::swap(stack[a], stack[b]);
+            }
+        }
+
+        rects.assign(parents.size(), WidgetRect{ 0, 0, 0, 0 });
+        dirty.assign(parents.size(), 1);
+        subtreeDirty.assign(parents.size(), 1);
+        moved.assign(parents.size(), 0);
+        addParents.clear(); addSpecs.clear(); addWidgets.clear();
+    }
+
+    size_t size() const { return parents.size(); }
+
+    /// change one node (e.g. an editor dragging a control); applied by the next update()
+    void setSpec(int32_t node, const LayoutSpec& spec) {
+        specs[node] = spec;
+        dirty[node] = 1;
+        for (int32_t p = parents[node]; p >= 0 && !subtreeDirty[p]; p = parents[p]) subtreeDirty[p] = 1;
+    }
+    const LayoutSpec& spec(int32_t node) const { return specs[node]; }
+
+    /// recompute against a window of w x h points; onMoved(widget, rect) for every
+    /// widget whose rect changed.  returns the number of nodes recomputed
+    template <typename OnMoved>
+    size_t update(float w, float h, OnMoved&& onMoved) {
+        const bool windowChanged = w != windowW || h != windowH;
+        windowW = w;
+        windowH = h;
+        const WidgetRect window{ 0.0f, 0.0f, w, h };
+
+        size_t computed = 0;
+        const uint32_t n = (uint32_t)parents.size();
+        for (uint32_t i = 0; i < n;) {
+            const int32_t p = parents[i];
+            const bool parentMoved = p < 0 ? windowChanged : moved[p] != 0;
+            if (!parentMoved && !dirty[i] && !subtreeDirty[i]) { // nothing in here can change
+                i = subtreeEnd[i];
+                continue;
+            }
+            moved[i] = 0;
+            if (parentMoved || dirty[i]) {
+                WidgetRect r = place(specs[i], p < 0 ? window : rects[p]);
+                ++computed;
+                if (r != rects[i]) {
+                    rects[i] = r;
+                    moved[i] = 1;
+                    if (widgets[i] != kNoWidget) onMoved(widgets[i], r);
+                }
+            }
+            dirty[i] = subtreeDirty[i] = 0;
+            ++i;
+        }
+        return computed;
+    }
+
+    /// results, one per node in pre-order
+    const std::vector<WidgetRect>& nodeRects() const { return rects; }
+
+private:
+    // as added
+    std::vector<int32_t> addParents;
+    std::vector<LayoutSpec> addSpecs;
+    std::vector<int32_t> addWidgets;
+
+    // pre-order
+    std::vector<int32_t> parents;
+    std::vector<LayoutSpec> specs;
+    std::vector<int32_t> widgets;
+    std::vector<uint32_t> subtreeEnd; // one past the node's last descendant
+    std::vector<WidgetRect> rects;
+    std::vector<uint8_t> dirty;        // spec changed
+    std::vector<uint8_t> subtreeDirty; // something below is dirty
+    std::vector<uint8_t> moved;        // rect changed in the current update()
+    float windowW = -1.0f, windowH = -1.0f;
+
+    static void placeAxis(const LayoutAxis& a, float parentPos, float parentSize, float& pos, float& size) {
+        size = a.size + a.rel * parentSize;
+        pos = parentPos + a.anchor * (parentSize - size) + a.offset;
+    }
+
+    static WidgetRect place(const LayoutSpec& s, const WidgetRect& parent) {
+        WidgetRect r;
+        placeAxis(s.x, parent.x, parent.w, r.x, r.w);
+        placeAxis(s.y, parent.y, parent.h, r.y, r.h);
+        return r;
+    }
+};
@@ -0,0 +1,162 @@
+#pragma once
+#include <atomic>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Parameter bridge between the audio (processor) thread and the GUI thread.
+//
+//   GUI thread:    guiSet()  -> toProcessor queue -> processorDrain()  (audio thread)
+//   audio thread:  processorSet() -> toGui queue  -> guiPoll()          (GUI thread)
+//
+// Every parameter has an atomic "latest value" slot, so a full queue never
+// loses state: the producer raises an overflow flag and the consumer resyncs
+// from the value slots.  The audio side only ever does atomic loads/stores
+// and index arithmetic: no locks, no allocation, no syscalls.
+
+/// Wait-free single-producer / single-consumer ring.  Capacity must be a power of two.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+public:
+    /// producer thread only. returns false if full (nothing is written)
+    bool push(const T& item) {
+        const size_t head = writePos.load(std::memory_order_relaxed);
+        if (head - readCache == Capacity) {
+            readCache = readPos.load(std::memory_order_acquire);
+            if (head - readCache == Capacity) return false;
+        }
+        slots[head & (Capacity - 1)] = item;
+        writePos.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// consumer thread only. returns false if empty
+    bool pop(T& item) {
+        const size_t tail = readPos.load(std::memory_order_relaxed);
+        if (tail == writeCache) {
+            writeCache = writePos.load(std::memory_order_acquire);
+            if (tail == writeCache) return false;
+        }
+        item = slots[tail & (Capacity - 1)];
+        readPos.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t capacity() const { return Capacity; }
+
+private:
+    // producer and consumer indices live on separate cache lines so the two
+    // threads don't false-share while streaming at full rate
+    alignas(64) std::atomic<size_t> writePos{0};
+    size_t readCache{0};   // producer's last view of readPos
+    alignas(64) std::atomic<size_t> readPos{0};
+    size_t writeCache{0};  // consumer's last view of writePos
+    alignas(64) std::array<T, Capacity> slots{};
+};
+
+struct ParamChange {
+    uint32_t id;
+    float value;
+};
+
+template <size_t NumParams, size_t QueueSize = 1024>
+class ParamStore {
+public:
+    static constexpr size_t kNumParams = NumParams;
+    static constexpr size_t kDirtyWords = (NumParams + 63) / 64;
+
+    ParamStore() {
+        for (auto& v : values) v.store(0.0f, std::memory_order_relaxed);
+        for (auto& d : dirty) d.store(0, std::memory_order_relaxed);
+    }
+
+    /// latest value, safe from any thread
+    float get(uint32_t id) const { return values[id].load(std::memory_order_relaxed); }
+
+    // ---------------- GUI thread ----------------
+
+    /// user edit from a widget; forwarded to the processor
+    void guiSet(uint32_t id, float value) {
+        if (id >= NumParams) return;
+        values[id].store(value, std::memory_order_relaxed);
+        if (!toProcessor.push({id, value}))
+            processorOverflow.store(true, std::memory_order_release);
+    }
+
+    /// drain processor->GUI traffic into the dirty bitset. returns true if anything changed
+    bool guiPoll() {
+        bool changed = false;
+        ParamChange c;
+        while (toGui.pop(c)) {
+            markDirty(c.id);
+            changed = true;
+        }
+        if (guiOverflow.exchange(false, std::memory_order_acquire)) {
+            for (auto& d : dirty) d.store(~uint64_t(0), std::memory_order_relaxed);
+            changed = true;
+        }
+        return changed;
+    }
+
+    /// mark a param dirty from the GUI side (e.g. after a local edit or reload)
+    void markDirty(uint32_t id) {
+        if (id >= NumParams) return;
+        dirty[id >> 6].fetch_or(uint64_t(1) << (id & 63), std::memory_order_relaxed);
+    }
+
+    /// call fn(id, value) once for every param changed since the last call, then clear
+    template <typename F>
+    void consumeDirty(F&& fn) {
+        for (size_t w = 0; w < kDirtyWords; ++w) {
+            uint64_t bits = dirty[w].exchange(0, std::memory_order_acq_rel);
+            while (bits) {
+                const uint32_t id = uint32_t(w * 64 + ctz64(bits));
+                bits &= bits - 1;
+                if (id < NumParams) fn(id, get(id));
+            }
+        }
+    }
+
+    // ---------------- audio thread ----------------
+
+    /// automation / meter value coming out of the processor
+    void processorSet(uint32_t id, float value) {
+        if (id >= NumParams) return;
+        values[id].store(value, std::memory_order_relaxed);
+        if (!toGui.push({id, value}))
+            guiOverflow.store(true, std::memory_order_release);
+    }
+
+    /// apply GUI edits: fn(id, value) per change. on queue overflow, every param is replayed
+    template <typename F>
+    void processorDrain(F&& fn) {
+        // take the flag before draining: edits still queued are older than the
+        // failed push, so they must go before the replay, never after it
+        const bool resync = processorOverflow.exchange(false, std::memory_order_acquire);
+        ParamChange c;
+        while (toProcessor.pop(c)) fn(c.id, c.value);
+        if (resync) {
+            for (uint32_t id = 0; id < NumParams; ++id) fn(id, get(id));
+        }
+    }
+
+private:
+    static int ctz64(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(v);
+#else
+        int n = 0;
+        while (!(v & 1)) { v >>= 1; ++n; }
+        return n;
+#endif
+    }
+
+    std::array<std::atomic<float>, NumParams> values;
+    std::array<std::atomic<uint64_t>, kDirtyWords> dirty;
+    std::atomic<bool> guiOverflow{false};
+    std::atomic<bool> processorOverflow{false};
+
+    SpscQueue<ParamChange, QueueSize> toProcessor;
+    SpscQueue<ParamChange, QueueSize> toGui;
+};
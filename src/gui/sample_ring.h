@@ -0,0 +1,75 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Audio -> GUI sample ring for meters and scopes.  One writer (the audio
+// thread) copies each block in; the GUI reads the newest samples in place,
+// as at most two spans of the ring's own memory, and never copies them out.
+//
+// There is no read position the writer waits on: the writer just keeps
+// overwriting the oldest samples.  The reader instead checks, after it has
+// looked at a span, that the writer hasn't lapped it in the meantime, and
+// drops that frame's result if it has.  The writer publishes its count every
+// quarter ring, so a reader that stays within the newest half never races.
+// Nothing allocates after construction and neither side ever blocks.
+
+class SampleRing {
+public:
+    /// capacity is rounded up to a power of two
+    explicit SampleRing(size_t capacity = 8192) {
+        size_t c = 64;
+        while (c < capacity) c <<= 1;
+        samples.assign(c, 0.0f);
+        mask = c - 1;
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+    // audio thread
+
+    void write(const float* in, size_t n) {
+        uint64_t w = written.load(std::memory_order_relaxed);
+        const size_t chunk = capacity() / 4;
+        while (n) {
+            size_t k = n < chunk ? n : chunk;
+            size_t at = (size_t)w & mask;
+            size_t first = k < capacity() - at ? k : capacity() - at;
+            memcpy(&samples[at], in, first * sizeof(float));
+            memcpy(&samples[0], in + first, (k - first) * sizeof(float));
+            w += k;
+            in += k;
+            n -= k;
+            written.store(w, std::memory_order_release);
+        }
+    }
+
+    // GUI thread
+
+    /// samples written so far; also the end position for read()
+    uint64_t writeCount() const { return written.load(std::memory_order_acquire); }
+
+    /// the n samples ending at end (a writeCount()), as fn(a, na, b, nb): a
+    /// first, then b (nb is 0 unless they wrap).  n is clamped to half the
+    /// ring.  returns false if the writer overwrote them while fn ran; the
+    /// caller should throw away whatever fn produced
+    template <typename Fn>
+    bool read(uint64_t end, size_t n, Fn&& fn) const {
+        if (n > capacity() / 2) n = capacity() / 2;
+        if (n > end) n = (size_t)end;
+        const uint64_t start = end - n;
+        const size_t at = (size_t)start & mask;
+        const size_t first = n < capacity() - at ? n : capacity() - at;
+        fn(&samples[at], first, &samples[0], n - first);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // the writer may be up to one chunk past what it has published
+        return written.load(std::memory_order_relaxed) + capacity() / 4 - start <= capacity();
+    }
+
+private:
+    std::vector<float> samples;
+    size_t mask = 0;
+    alignas(64) std::atomic<uint64_t> written{ 0 };
+};
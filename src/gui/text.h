@@ -0,0 +1,233 @@
+#pragma once
+#include "renderer.h"
+#include "shapes.h"
+#include "font_mono7x13.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Text drawn as runs of glyph quads out of a single atlas texture, so a
+// whole panel of labels and displays goes through the same batched quad path
+// as the knobs.  The atlas is rasterized once per Renderer from the built-in
+// bitmap font, and also carries a block of solid white texels so text
+// backgrounds (and any other flat-colored rect) can share the same texture.
+
+enum class TextAlign { Left, Center, Right };
+
+inline TextAlign parseTextAlign(std::string_view s) {
+    if (s == "left") return TextAlign::Left;
+    if (s == "right") return TextAlign::Right;
+    return TextAlign::Center;
+}
+
+/// pack 0..255 channels into the Quad::color layout
+inline uint32_t packColor(unsigned r, unsigned g, unsigned b, unsigned a) {
+    return (a << 24) | (b << 16) | (g << 8) | r;
+}
+
+/// glyph quads for one string, relative to the top-left of the line
+struct ShapedText {
+    std::vector<Quad> quads;
+    float width = 0.0f;
+    float height = 0.0f;
+};
+
+class GlyphAtlas {
+public:
+    static constexpr int kCols = 16;
+    static constexpr int kCellStrideX = kFontCellW + 1; // 1px gutter so linear filtering can't bleed
+    static constexpr int kCellStrideY = kFontCellH + 1;
+    static constexpr int kWidth = 128;
+    static constexpr int kHeight = 128;
+    static constexpr int kWhiteX = kWidth - 4; // 4x4 solid block in the bottom-right corner
+    static constexpr int kWhiteY = kHeight - 4;
+
+    void init(Renderer& renderer) {
+        static_assert(kCols * kCellStrideX <= kWidth, "atlas too narrow for font");
+        static_assert(((kFontLastChar - kFontFirstChar) / kCols + 1) * kCellStrideY <= kWhiteY, "atlas too short for font");
+
+        std::vector<char> pixels(kWidth * kHeight * 4, 0);
+        auto put = [&pixels](int x, int y) {
+            char* p = &pixels[(y * kWidth + x) * 4];
+            p[0] = p[1] = p[2] = p[3] = (char)0xFF;
+        };
+        for (int c = kFontFirstChar; c <= kFontLastChar; ++c) {
+            int cx, cy;
+            cellOrigin(c, cx, cy);
+            const uint8_t* rows = kFontMono7x13[c - kFontFirstChar];
+            for (int y = 0; y < kFontCellH; ++y)
+                for (int x = 0; x < kFontCellW; ++x)
+                    if (rows[y] & (0x80 >> x)) put(cx + x, cy + y);
+        }
+        for (int y = kWhiteY; y < kHeight; ++y)
+            for (int x = kWhiteX; x < kWidth; ++x)
+                put(x, y);
+
+        // opaque white and fully transparent texels are the same in every
+        // channel order and already premultiplied, so no convertPixels needed
+        texId = renderer.createTexture(Texture(kWidth, kHeight, pixels.data()));
+    }
+
+    unsigned int texId = 0;
+
+    /// uv rect of a glyph cell; unknown characters map to '?'
+    void glyphUV(char c, float& u0, float& v0, float& u1, float& v1) const {
+        int cx, cy;
+        cellOrigin(c, cx, cy);
+        u0 = float(cx) / kWidth;
+        v0 = float(cy) / kHeight;
+        u1 = float(cx + kFontCellW) / kWidth;
+        v1 = float(cy + kFontCellH) / kHeight;
+    }
+
+    /// a uv inside the solid block; sampling there gives opaque white
+    void whiteUV(float& u, float& v) const {
+        u = (kWhiteX + 2.0f) / kWidth;
+        v = (kWhiteY + 2.0f) / kHeight;
+    }
+
+private:
+    static void cellOrigin(int c, int& x, int& y) {
+        if (c < kFontFirstChar || c > kFontLastChar) c = '?';
+        int i = c - kFontFirstChar;
+        x = (i % kCols) * kCellStrideX;
+        y = (i / kCols) * kCellStrideY;
+    }
+};
+
+/// one atlas + shaping cache per GPU share group
+class TextSystem {
+public:
+    explicit TextSystem(Renderer& renderer) { atlas.init(renderer); }
+
+    GlyphAtlas atlas;
+
+    /// shaping is cached per string in a fixed table: repeated values on a
+    /// display cost one lookup, and one under automation (a new string every
+    /// frame) overwrites a slot in place instead of growing the cache, so once
+    /// the slots have seen strings that long it allocates nothing.  The result
+    /// is valid until the next shape()
+    const ShapedText& shape(const std::string& s) {
+        Slot& slot = cache[std::hash<std::string>()(s) % kCacheSlots];
+        if (slot.used && slot.key == s) return slot.shaped;
+
+        slot.used = true;
+        slot.key.assign(s);
+        ShapedText& out = slot.shaped;
+        out.quads.clear();
+        float penX = 0.0f;
+        for (char c : s) {
+            if (c != ' ') {
+                Quad q(penX, 0.0f, (float)kFontCellW, (float)kFontCellH);
+                float u0, v0, u1, v1;
+                atlas.glyphUV(c, u0, v0, u1, v1);
+                q.uvs = { u0, v0, u1, v0, u0, v1, u1, v1 };
+                out.quads.push_back(q);
+            }
+            penX += (float)kFontCellW;
+        }
+        out.width = penX;
+        out.height = (float)kFontCellH;
+        return out;
+    }
+
+    /// a flat-colored rect that samples the atlas' white block
+    Quad solidQuad(float x, float y, float w, float h, uint32_t color) const {
+        Quad q(x, y, w, h);
+        float u, v;
+        atlas.whiteUV(u, v);
+        q.uvs = { u, v, u, v, u, v, u, v };
+        q.setColor(color);
+        return q;
+    }
+
+    /// gradients, AA lines and rounded rects appended to out; like solidQuad
+    /// they sample the white block, so they batch with the text
+    ShapeBuilder shapes(std::vector<Quad>& out) const {
+        float u, v;
+        atlas.whiteUV(u, v);
+        return ShapeBuilder(out, u, v);
+    }
+
+private:
+    static constexpr size_t kCacheSlots = 256; // a large panel's labels, plus room for changing values
+
+    struct Slot {
+        bool used = false;
+        std::string key;
+        ShapedText shaped;
+    };
+    Slot cache[kCacheSlots];
+};
+
+/// shared by every Renderer in the share group, like the atlas texture itself
+inline TextSystem& textSystemFor(Renderer& renderer) {
+    static std::unordered_map<uint64_t, std::unique_ptr<TextSystem>> systems;
+    auto& ts = systems[renderer.shareGroup()];
+    if (!ts) ts = std::make_unique<TextSystem>(renderer);
+    return *ts;
+}
+
+/// the quads for one label or display: optional background, then glyphs.
+/// setText() only rewrites this block's own quads; setRect() re-lays out the
+/// current text in a new rect (a pure move just shifts the quads)
+struct TextBlock {
+    TextSystem* system = nullptr;
+    float x = 0, y = 0, w = 0, h = 0;
+    TextAlign align = TextAlign::Center;
+    uint32_t color = 0xFFFFFFFF;
+    uint32_t bgColor = 0;
+    bool hasBackground = false;
+    std::string text;
+    std::vector<Quad> quads;
+
+    void setText(const std::string& s) {
+        const ShapedText& shaped = system->shape(s);
+        if (&s != &text) text = s;
+        quads.clear();
+        if (hasBackground) quads.push_back(system->solidQuad(x, y, w, h, bgColor));
+
+        float ox = x;
+        if (align == TextAlign::Center) ox = x + (w - shaped.width) * 0.5f;
+        else if (align == TextAlign::Right) ox = x + w - shaped.width;
+        float oy = y + (h - shaped.height) * 0.5f;
+        ox = (float)(int)ox; // keep glyphs on whole pixels, the font is a bitmap
+        oy = (float)(int)oy;
+
+        for (const Quad& g : shaped.quads) {
+            Quad q = g;
+            for (int i = 0; i < 4; ++i) {
+                q.verts[i * 2 + 0] += ox;
+                q.verts[i * 2 + 1] += oy;
+            }
+            q.setColor(color);
+            quads.push_back(q);
+        }
+    }
+
+    void setRect(float nx, float ny, float nw, float nh) {
+        if (nw == w && nh == h) {
+            // moved by whole pixels: shifting lands every quad where setText() would put it
+            float dx = (float)(int)(nx - x), dy = (float)(int)(ny - y);
+            if (dx == nx - x && dy == ny - y) {
+                x = nx;
+                y = ny;
+                for (Quad& q : quads)
+                    for (int i = 0; i < 4; ++i) {
+                        q.verts[i * 2 + 0] += dx;
+                        q.verts[i * 2 + 1] += dy;
+                    }
+                return;
+            }
+        }
+        x = nx; y = ny; w = nw; h = nh;
+        setText(text);
+    }
+
+    void draw(Renderer& renderer) const {
+        for (const Quad& q : quads) renderer.addQuad(q, system->atlas.texId);
+    }
+};
@@ -0,0 +1,240 @@
+#pragma once
+#include "renderer.h"
+#include "mip_chain.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Layout textures, loaded once per file and streamed in without blocking the
+// first frame.  get() only peeks at the image header for its size, reserves
+// the GPU texture and starts decoding on a worker; until the pixels have been
+// uploaded (a slice per frame, see Renderer::streamTexture) quads using it draw
+// the renderer's placeholder.  pump() once per frame moves finished decodes
+// over to the renderer.
+//
+// For each layout path the cache picks, in order:
+//   "knob.sdf.png"                                            (any scale)
+//   "knob@2x.bc7.ktx2" / "knob@2x.etc2.ktx2" / "knob@2x.png"  (contentScale > 1)
+//   "knob.bc7.ktx2" / "knob.etc2.ktx2" / "knob.png"
+// taking a compressed file only if the device can sample it.  Entry sizes
+// are in layout points, so @2x art lands on the same rect as @1x art.
+//
+// A ".sdf.png" is a distance field made by tools/sdfgen from a one-color
+// shape: a few times smaller than the art it replaces, drawn with the SDF
+// shader in the widget's tint and sharp at every scale.  Its entry keeps the
+// source art's size, which sdfgen stores in the file.
+
+struct TextureCache {
+    struct Entry { unsigned int texId; int width; int height; bool sdf = false; };
+    std::unordered_map<std::string, Entry> entries;
+    size_t rgbaBytes = 0; // VRAM the assets would take as RGBA8 (with mips)
+    size_t gpuBytes = 0;  // VRAM they actually take
+
+    /// free every loaded texture so a reload re-reads edited art; waits for decodes
+    /// still running.  widgets still using the old ids (e.g. other windows that
+    /// weren't reloaded) draw nothing for them.  a plain loadGUI from another
+    /// window skips this and shares the textures
+    void beginLoad(Renderer& renderer) {
+        pending.clear();
+        for (const auto& e : entries) renderer.destroyTexture(e.second.texId);
+        entries.clear();
+        rgbaBytes = gpuBytes = 0;
+    }
+
+    /// never blocks on decoding; LoadFn(path) -> straight-alpha RGBA8 Texture allocated with new[]
+    template <typename LoadFn>
+    const Entry& get(Renderer& renderer, const std::string& path, LoadFn&& load) {
+        auto it = entries.find(path);
+        if (it != entries.end()) return it->second;
+
+        Selection sel{ renderer.contentScale(),
+                       renderer.supportsCompressedFormat(CompressedFormat::BC7_RGBA),
+                       renderer.supportsCompressedFormat(CompressedFormat::ETC2_RGBA8),
+                       renderer.nativePixelFormat() };
+        Entry e{ 0, 0, 0 };
+        int w = 0, h = 0;
+        std::string file = stemOf(path) + ".sdf.png";
+        if (exists(file) && sdfSize(file, w, h, e.width, e.height)) {
+            e.texId = decode(renderer, sel, file, w, h, load);
+            e.sdf = true;
+            renderer.setTextureShader(e.texId, TextureShader::Sdf);
+            const size_t art = (size_t)e.width * e.height * 4 * 4 / 3; // what the art itself would take
+            rgbaBytes += art - std::min(art, (size_t)w * h * 4 * 4 / 3);
+            return entries.emplace(path, e).first->second;
+        }
+        if (loadCompressed(renderer, sel, path, e)) return entries.emplace(path, e).first->second;
+
+        int artScale = 1;
+        file = pickFile(sel, path, extOf(path).c_str(), artScale);
+        if (!pngSize(file, w, h)) {
+            printf("ERROR: could not read texture '%s'\n", file.c_str());
+            return entries.emplace(path, e).first->second;
+        }
+        e = Entry{ decode(renderer, sel, file, w, h, load), w / artScale, h / artScale };
+        return entries.emplace(path, e).first->second;
+    }
+
+    /// hand every finished decode to the renderer's upload queue; cheap when idle
+    void pump(Renderer& renderer) {
+        for (size_t i = 0; i < pending.size();) {
+            Pending& p = pending[i];
+            if (p.result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) { ++i; continue; }
+            try {
+                std::shared_ptr<Decoded> d = p.result.get();
+                renderer.streamTexture(p.texId, TextureUpload{ d->mips.levels, d });
+            } catch (const std::exception& e) {
+                printf("ERROR: decoding '%s' failed: %s\n", p.file.c_str(), e.what());
+                renderer.streamTexture(p.texId, TextureUpload{}); // nothing coming; placeholder stays
+            }
+            pending[i] = std::move(pending.back());
+            pending.pop_back();
+        }
+    }
+
+    bool loading() const { return !pending.empty(); }
+
+private:
+    // what file selection needs to know about the renderer
+    struct Selection {
+        float contentScale;
+        bool bc7, etc2;
+        PixelFormat pixelFormat;
+    };
+
+    struct Decoded {
+        std::unique_ptr<char[]> pixels; // level 0
+        MipChain mips;                  // level 0 aliases pixels
+    };
+
+    struct Pending {
+        unsigned int texId;
+        std::string file;
+        std::future<std::shared_ptr<Decoded>> result;
+    };
+    std::vector<Pending> pending;
+
+    static bool exists(const std::string& file) {
+        FILE* fp = fopen(file.c_str(), "rb");
+        if (fp) fclose(fp);
+        return fp != nullptr;
+    }
+
+    static std::string stemOf(const std::string& path) {
+        return path.substr(0, path.rfind('.'));
+    }
+
+    static std::string extOf(const std::string& path) {
+        size_t dot = path.rfind('.');
+        return dot == std::string::npos ? std::string() : path.substr(dot);
+    }
+
+    // "<stem>@2x<suffix>" if the display wants it and it's there, else "<stem><suffix>"
+    static std::string pickFile(const Selection& sel, const std::string& path, const char* suffix, int& artScale) {
+        std::string hi = stemOf(path) + "@2x" + suffix;
+        artScale = sel.contentScale > 1.0f && exists(hi) ? 2 : 1;
+        return artScale == 2 ? hi : stemOf(path) + suffix;
+    }
+
+    // reserve a w x h texture and decode file into it on a worker
+    template <typename LoadFn>
+    unsigned int decode(Renderer& renderer, const Selection& sel, const std::string& file, int w, int h, LoadFn& load) {
+        unsigned int texId = renderer.reserveTexture(w, h, true);
+        size_t bytes = (size_t)w * h * 4 * 4 / 3; // level 0 + mip chain
+        rgbaBytes += bytes;
+        gpuBytes += bytes;
+
+        PixelFormat format = sel.pixelFormat;
+        auto fn = load;
+        pending.push_back({ texId, file, std::async(std::launch::async, [file, format, fn]() {
+            auto d = std::make_shared<Decoded>();
+            Texture tex = fn(file.c_str());
+            d->pixels.reset(tex.data);
+            convertPixels(reinterpret_cast<uint8_t*>(tex.data), (size_t)tex.width * tex.height, format, true);
+            buildMipChain(tex, d->mips);
+            return d;
+        }) });
+        return texId;
+    }
+
+    // pixel size, plus the source art's size from sdfgen's "suba-sdf" text
+    // chunk (which comes before the image data); the pixel size if it's missing
+    static bool sdfSize(const std::string& file, int& w, int& h, int& artW, int& artH) {
+        if (!pngSize(file, w, h)) return false;
+        artW = w;
+        artH = h;
+        FILE* fp = fopen(file.c_str(), "rb");
+        if (!fp) return false;
+        unsigned char chunk[8];
+        fseek(fp, 8, SEEK_SET); // signature
+        while (fread(chunk, 1, 8, fp) == 8 && memcmp(chunk + 4, "IDAT", 4) != 0) {
+            const uint32_t len = ((uint32_t)chunk[0] << 24) | (chunk[1] << 16) | (chunk[2] << 8) | chunk[3];
+            char text[64] = {};
+            if (memcmp(chunk + 4, "tEXt", 4) == 0 && len < sizeof(text) && fread(text, 1, len, fp) == len) {
+                int aw = 0, ah = 0;
+                if (strcmp(text, "suba-sdf") == 0 && sscanf(text + 9, "%d %d", &aw, &ah) == 2 && aw > 0 && ah > 0) {
+                    artW = aw;
+                    artH = ah;
+                }
+                fseek(fp, 4, SEEK_CUR); // crc
+            } else {
+                fseek(fp, (long)len + 4, SEEK_CUR);
+            }
+        }
+        fclose(fp);
+        return true;
+    }
+
+    // width/height from the IHDR chunk, without decoding
+    static bool pngSize(const std::string& file, int& w, int& h) {
+        unsigned char hdr[24];
+        FILE* fp = fopen(file.c_str(), "rb");
+        if (!fp) return false;
+        bool ok = fread(hdr, 1, sizeof(hdr), fp) == sizeof(hdr) && memcmp(hdr + 12, "IHDR", 4) == 0;
+        fclose(fp);
+        if (!ok) return false;
+        w = (hdr[16] << 24) | (hdr[17] << 16) | (hdr[18] << 8) | hdr[19];
+        h = (hdr[20] << 24) | (hdr[21] << 16) | (hdr[22] << 8) | hdr[23];
+        return w > 0 && h > 0;
+    }
+
+    // compressed files are small and need no decode, so they upload right away
+    bool loadCompressed(Renderer& renderer, const Selection& sel, const std::string& path, Entry& e) {
+        const CompressedFormat formats[] = { CompressedFormat::BC7_RGBA, CompressedFormat::ETC2_RGBA8 };
+        for (int scale = sel.contentScale > 1.0f ? 2 : 1; scale >= 1; --scale) {
+            for (CompressedFormat format : formats) {
+                if (!(format == CompressedFormat::BC7_RGBA ? sel.bc7 : sel.etc2)) continue;
+                std::string file = stemOf(path) + (scale == 2 ? "@2x" : "") + compressedSuffix(format);
+                CompressedTexture ct;
+                if (!loadKTX2(file.c_str(), ct)) continue;
+                if (!ct.premultiplied)
+                    printf("WARNING: %s is not flagged premultiplied; edges will blend wrong\n", file.c_str());
+                unsigned int id = renderer.createTexture(ct);
+                if (!id) continue; // driver advertised the format but rejected the data
+                e = Entry{ id, ct.width / scale, ct.height / scale };
+                rgbaBytes += ct.rgbaBytes();
+                gpuBytes += ct.data.size();
+                printf("texture %s: %zu KiB compressed, saves %zu KiB over RGBA\n", file.c_str(),
+                       ct.data.size() / 1024, (ct.rgbaBytes() - ct.data.size()) / 1024);
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+/// one cache per GPU share group (i.e. per process), kept across loadGUI calls:
+/// decodes finish after it returns, and every editor window draws the same
+/// skin from the same textures
+inline TextureCache& textureCacheFor(Renderer& renderer) {
+    static std::unordered_map<uint64_t, std::unique_ptr<TextureCache>> caches;
+    auto& tc = caches[renderer.shareGroup()];
+    if (!tc) tc = std::make_unique<TextureCache>();
+    return *tc;
+}
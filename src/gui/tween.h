@@ -0,0 +1,129 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Tweens for timed visuals (kick flashes, splash fades).  Active tweens live
+// in parallel arrays and update() evaluates all of them in one straight pass:
+// every easing curve is a cubic with per-tween coefficients, so there is no
+// branch per tween and the loop vectorizes.  Only then are results handed
+// back, one callback per tween whose output changed, so widgets that aren't
+// animating are never touched.  Finished tweens are dropped; when none are
+// left active() is false and the caller can stop drawing until something
+// else happens.
+
+enum class TweenProp : uint8_t {
+    Alpha, // color alpha, 0..1
+    Frame, // filmstrip frame, rounded
+};
+
+enum class Ease : uint8_t { Linear, In, Out, InOut };
+
+class Animator {
+public:
+    /// tween widget's prop from -> to over seconds, starting after delay.
+    /// replaces a running tween of the same widget and prop
+    void start(uint64_t nowNs, uint32_t widget, TweenProp prop, float from, float to, float seconds,
+               Ease ease = Ease::InOut, float delay = 0.0f) {
+        if (widgets.empty()) epochNs = nowNs; // keeps times small enough for float
+        size_t i = 0;
+        for (; i < widgets.size(); ++i)
+            if (widgets[i] == widget && props[i] == prop) break;
+        if (i == widgets.size()) {
+            widgets.push_back(widget);
+            props.push_back(prop);
+            starts.push_back(0); invDurations.push_back(0);
+            froms.push_back(0); delta.push_back(0);
+            c1.push_back(0); c2.push_back(0); c3.push_back(0);
+            values.push_back(0); applied.push_back(0);
+        }
+        starts[i] = toSeconds(nowNs) + delay;
+        invDurations[i] = seconds > 0.0f ? 1.0f / seconds : 1e9f;
+        froms[i] = from;
+        delta[i] = to - from;
+        curve(ease, c1[i], c2[i], c3[i]);
+        applied[i] = from - 1.0f; // force the first apply
+    }
+
+    /// drop every tween of one widget (e.g. it was hidden by other means)
+    void stop(uint32_t widget) {
+        for (size_t i = 0; i < widgets.size();)
+            if (widgets[i] == widget) remove(i);
+            else ++i;
+    }
+
+    bool active() const { return !widgets.empty(); }
+    size_t size() const { return widgets.size(); }
+
+    /// evaluate every tween at nowNs; apply(widget, prop, value) for each whose
+    /// value moved.  returns active()
+    template <typename Apply>
+    bool update(uint64_t nowNs, Apply&& apply) {
+        const size_t n = widgets.size();
+        if (!n) return false;
+        const float now = toSeconds(nowNs);
+
+        // one pass over flat floats, no branches: t in 0..1, eased, mapped to the range
+        const float* s = starts.data();
+        const float* inv = invDurations.data();
+        const float* a = froms.data();
+        const float* d = delta.data();
+        const float* k1 = c1.data();
+        const float* k2 = c2.data();
+        const float* k3 = c3.data();
+        float* v = values.data();
+        for (size_t i = 0; i < n; ++i) {
+            float t = (now - s[i]) * inv[i];
+            t = t < 0.0f ? 0.0f : t > 1.0f ? 1.0f : t;
+            float e = ((k3[i] * t + k2[i]) * t + k1[i]) * t;
+            v[i] = a[i] + d[i] * e;
+        }
+
+        for (size_t i = 0; i < widgets.size();) {
+            if (values[i] != applied[i]) {
+                applied[i] = values[i];
+                apply(widgets[i], props[i], values[i]);
+            }
+            if (now >= starts[i] + 1.0f / invDurations[i]) remove(i); // landed on its end value
+            else ++i;
+        }
+        return active();
+    }
+
+private:
+    uint64_t epochNs = 0;
+    std::vector<uint32_t> widgets;
+    std::vector<TweenProp> props;
+    std::vector<float> starts;       // seconds since epochNs
+    std::vector<float> invDurations;
+    std::vector<float> froms, delta;
+    std::vector<float> c1, c2, c3;   // ease(t) = c1 t + c2 t^2 + c3 t^3
+    std::vector<float> values;       // this update's output
+    std::vector<float> applied;      // last value handed out
+
+    float toSeconds(uint64_t ns) const { return (float)((double)(int64_t)(ns - epochNs) * 1e-9); }
+
+    static void curve(Ease ease, float& k1, float& k2, float& k3) {
+        switch (ease) {
+        case Ease::Linear: k1 = 1.0f; k2 = 0.0f;  k3 = 0.0f;  break;
+        case Ease::In:     k1 = 0.0f; k2 = 1.0f;  k3 = 0.0f;  break; // t^2
+        case Ease::Out:    k1 = 2.0f; k2 = -1.0f; k3 = 0.0f;  break; // 1 - (1-t)^2
+        case Ease::InOut:  k1 = 0.0f; k2 = 3.0f;  k3 = -2.0f; break; // smoothstep
+        }
+    }
+
+    void remove(size_t i) {
+        const size_t last = widgets.size() - 1;
+        widgets[i] = widgets[last]; widgets.pop_back();
+        props[i] = props[last]; props.pop_back();
+        starts[i] = starts[last]; starts.pop_back();
+        invDurations[i] = invDurations[last]; invDurations.pop_back();
+        froms[i] = froms[last]; froms.pop_back();
+        delta[i] = delta[last]; delta.pop_back();
+        c1[i] = c1[last]; c1.pop_back();
+        c2[i] = c2[last]; c2.pop_back();
+        c3[i] = c3[last]; c3.pop_back();
+        values[i] = values[last]; values.pop_back();
+        applied[i] = applied[last]; applied.pop_back();
+    }
+};
@@ -0,0 +1,610 @@
+#pragma once
+#include "renderer.h"
+#include "formatters.h"
+#include "text.h"
+#include "texture_cache.h"
+#include "layout_tree.h"
+#include "tween.h"
+#include "sample_ring.h"
+#include "decimate.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// All widgets of a panel live in one WidgetTable: parallel arrays indexed by
+// widget, no per-widget heap objects.  The per-frame path (param -> frame ->
+// uvs -> quads) only touches the flat hot arrays; text blocks and other rarely
+// used data sit in side tables referenced by index.  Outside itself the table
+// owns only its layer's render target, so replacing, clearing or destroying it
+// frees every widget at once; it must not outlive the Renderer it draws with.
+// Placement comes from the table's LayoutTree; resize() feeds it the window
+// size and only widgets that actually moved get their rects rewritten.
+// Timed visuals (kick flashes, splash timeouts) run on the table's Animator;
+// needsDraw() tells the loop when there is nothing new to show.
+//
+// Widgets that can't change on their own (background, labels, single-frame
+// art) are flattened into one offscreen layer texture, so a frame is one
+// layer quad plus the dynamic controls.  The layer is re-rendered only when
+// one of its members changes, anything moves or the content scale changes.
+//
+// Meters and scopes read a SampleRing the audio thread writes.  Each frame
+// they look at the new samples in place, reduce them with min/max (one pair
+// per point column for a scope, one peak for a meter) and emit solid quads
+// from buffers sized when the widget is placed, so drawing them allocates
+// nothing.
+
+enum class WidgetType : uint8_t {
+    Background,
+    Knob,
+    Button,
+    KickButton,
+    Display,
+    Label,
+    Splash,
+    Listbox,
+    Meter,
+    Scope,
+    Unknown
+};
+
+inline WidgetType parseWidgetType(std::string_view s) {
+    if (s == "background") return WidgetType::Background;
+    if (s == "knob")       return WidgetType::Knob;
+    if (s == "button")     return WidgetType::Button;
+    if (s == "kickButton") return WidgetType::KickButton;
+    if (s == "display")    return WidgetType::Display;
+    if (s == "label")      return WidgetType::Label;
+    if (s == "splash")     return WidgetType::Splash;
+    if (s == "listbox")    return WidgetType::Listbox;
+    if (s == "meter")      return WidgetType::Meter;
+    if (s == "scope")      return WidgetType::Scope;
+    return WidgetType::Unknown;
+}
+
+enum class FilmstripOrientation : uint8_t { Vertical, Horizontal };
+
+struct UVRect { float u0, v0, u1, v1; };
+
+enum WidgetFlags : uint8_t {
+    kWidgetHasQuad = 1 << 0, // draws a textured quad (false for pure text widgets)
+    kWidgetDirty   = 1 << 1, // rect/uv/color changed since the last buildQuads()
+    kWidgetLayered = 1 << 2, // drawn by the static layer, not every frame
+};
+
+constexpr float kMeterFloorDb = -60.0f;     // bottom of the scale
+constexpr float kMeterFallDbPerSecond = 24.0f;
+
+/// a meter or scope: where its samples come from and the quads it drew last
+struct SignalView {
+    const SampleRing* ring = nullptr;   // nullptr: draws its background only
+    const TextSystem* system = nullptr; // solid quads use its atlas
+    uint32_t window = 1024;             // scope: samples across the width
+    uint32_t color = 0xFF80E040;
+    uint32_t bgColor = 0;
+    bool hasBackground = false;
+    bool stale = true;                  // placed or resized: rebuild even without new samples
+    uint64_t seen = 0;                  // ring writeCount() already shown
+    uint64_t lastNs = 0;
+    float levelDb = kMeterFloorDb;      // meter: shown peak, falls back over time
+    std::vector<float> mins, maxs;      // scope: one per column
+    std::vector<Quad> quads;
+};
+
+/// a render target destroyed with its owner; moves, never copies
+struct OwnedRenderTarget {
+    Renderer*    renderer = nullptr;
+    unsigned int id = 0;
+
+    OwnedRenderTarget() = default;
+    OwnedRenderTarget(Renderer& r, unsigned int target) : renderer(&r), id(target) {}
+    OwnedRenderTarget(const OwnedRenderTarget&) = delete;
+    OwnedRenderTarget& operator=(const OwnedRenderTarget&) = delete;
+    OwnedRenderTarget(OwnedRenderTarget&& o) noexcept : renderer(o.renderer), id(o.id) { o.id = 0; }
+    OwnedRenderTarget& operator=(OwnedRenderTarget&& o) noexcept {
+        if (this != &o) {
+            reset();
+            renderer = o.renderer;
+            id = o.id;
+            o.id = 0;
+        }
+        return *this;
+    }
+    ~OwnedRenderTarget() { reset(); }
+
+    void reset() {
+        if (id) renderer->destroyRenderTarget(id);
+        id = 0;
+    }
+};
+
+struct WidgetTable {
+    // ---- hot: touched every frame / every param change ----
+    std::vector<WidgetRect>   rects;
+    std::vector<UVRect>       uvs;
+    std::vector<uint32_t>     colors;
+    std::vector<unsigned int> texIds;
+    std::vector<int32_t>      paramIds;   // ParamId, -1 if unbound
+    std::vector<uint8_t>      flags;      // WidgetFlags
+    std::vector<WidgetType>   types;
+    std::vector<uint16_t>     frameCounts;
+    std::vector<uint16_t>     frames;
+    std::vector<FilmstripOrientation> orientations;
+    std::vector<float>        values;
+    std::vector<Quad>         quads;      // output of buildQuads(), one per widget
+
+    // ---- param -> widgets index, rebuilt on first use after bindParam() ----
+    std::vector<uint32_t>     paramStart;   // widgets of param p: paramWidgets[paramStart[p] .. paramStart[p + 1])
+    std::vector<uint32_t>     paramWidgets;
+    bool                      paramIndexStale = false;
+
+    // ---- cold: only widgets that show text ----
+    std::vector<int32_t>      textIndex;  // into texts/formatted, -1 if none
+    std::vector<TextBlock>    texts;
+    std::vector<CachedText>   formatted;
+    std::vector<uint32_t>     timeoutsMs; // splash: hide this long after showing, 0 = stay
+
+    // ---- cold: meters and scopes ----
+    std::vector<int32_t>      signalIndex; // into signals, -1 if none
+    std::vector<SignalView>   signals;
+
+    LayoutTree                layout;     // widget rects are its output
+    Animator                  animator;
+    bool                      redraw = true; // something changed since the last draw()
+
+    // ---- static layer ----
+    bool                      useLayer = true;   // false: draw every widget every frame
+    bool                      layerStale = true; // members or their looks changed
+    OwnedRenderTarget         layerTarget;       // id 0 until built
+    WidgetRect                layerRect{ 0, 0, 0, 0 };
+    float                     layerScale = 0.0f; // contentScale() it was rendered at
+
+    size_t size() const { return rects.size(); }
+
+    void reserve(size_t n) {
+        rects.reserve(n); uvs.reserve(n); colors.reserve(n); texIds.reserve(n);
+        paramIds.reserve(n); flags.reserve(n); types.reserve(n); frameCounts.reserve(n);
+        frames.reserve(n); orientations.reserve(n); values.reserve(n); quads.reserve(n);
+        textIndex.reserve(n); timeoutsMs.reserve(n); signalIndex.reserve(n);
+    }
+
+    void clear() { *this = WidgetTable(); }
+
+    /// textured widget; (w, h) is the full texture size, frames split it into a filmstrip
+    size_t addQuadWidget(WidgetType type, float x, float y, float w, float h, unsigned int texId,
+                         int frameCount = 1, FilmstripOrientation orient = FilmstripOrientation::Vertical) {
+        if (frameCount < 1) frameCount = 1;
+        if (orient == FilmstripOrientation::Vertical) h /= frameCount;
+        else w /= frameCount;
+        size_t i = push(type, x, y, w, h);
+        texIds[i] = texId;
+        flags[i] |= kWidgetHasQuad;
+        frameCounts[i] = (uint16_t)frameCount;
+        orientations[i] = orient;
+        setFrame(i, 0);
+        return i;
+    }
+
+    size_t addTextWidget(WidgetType type, const TextBlock& block) {
+        size_t i = push(type, block.x, block.y, block.w, block.h);
+        textIndex[i] = (int32_t)texts.size();
+        texts.push_back(block);
+        formatted.emplace_back();
+        return i;
+    }
+
+    size_t addSignalWidget(WidgetType type, float x, float y, float w, float h, SignalView view,
+                           FilmstripOrientation orient = FilmstripOrientation::Vertical) {
+        size_t i = push(type, x, y, w, h);
+        orientations[i] = orient;
+        signalIndex[i] = (int32_t)signals.size();
+        signals.push_back(std::move(view));
+        sizeSignal(i);
+        return i;
+    }
+
+    TextBlock* textBlock(size_t i) { return textIndex[i] < 0 ? nullptr : &texts[textIndex[i]]; }
+    CachedText* cachedText(size_t i) { return textIndex[i] < 0 ? nullptr : &formatted[textIndex[i]]; }
+
+    // a filmstrip texture holds every state of the control; switching state
+    // only rewrites the uvs, so the texture binding (and batch) never changes
+    void setFrame(size_t i, int f) {
+        const int n = frameCounts[i];
+        f = f < 0 ? 0 : f >= n ? n - 1 : f;
+        frames[i] = (uint16_t)f;
+        float a = float(f) / n, b = float(f + 1) / n;
+        uvs[i] = orientations[i] == FilmstripOrientation::Vertical ? UVRect{ 0.0f, a, 1.0f, b }
+                                                                   : UVRect{ a, 0.0f, b, 1.0f };
+        flags[i] |= kWidgetDirty;
+        touched(i);
+    }
+
+    /// 0..1 over the widget's tint (and text color); 0 skips drawing it
+    void setAlpha(size_t i, float a) {
+        uint32_t byte = (uint32_t)((a < 0.0f ? 0.0f : a > 1.0f ? 1.0f : a) * 255.0f + 0.5f);
+        if (!byte != !(colors[i] >> 24) && isStatic(i)) layerStale = true; // shown or hidden: may join the layer
+        colors[i] = (colors[i] & 0x00FFFFFFu) | (byte << 24);
+        flags[i] |= kWidgetDirty;
+        if (textIndex[i] >= 0) {
+            TextBlock& tb = texts[textIndex[i]];
+            tb.color = (tb.color & 0x00FFFFFFu) | (byte << 24);
+            tb.setText(tb.text);
+        }
+        touched(i);
+    }
+
+    /// bind widget i to param id (-1 unbinds)
+    void bindParam(size_t i, int32_t id) {
+        paramIds[i] = id;
+        paramIndexStale = true;
+    }
+
+    /// new value from the ParamStore for every widget bound to param id.
+    /// a display only re-lays out its glyphs if the formatted string changed
+    void applyParam(int32_t id, float value) {
+        if (paramIndexStale) buildParamIndex();
+        if (id < 0 || (size_t)id + 1 >= paramStart.size()) return;
+        for (uint32_t k = paramStart[id], end = paramStart[id + 1]; k < end; ++k) {
+            const size_t i = paramWidgets[k];
+            const bool wasOn = values[i] > 0.5f, on = value > 0.5f;
+            values[i] = value;
+            if (types[i] == WidgetType::KickButton && on && !wasOn) kick(i);
+            else if (types[i] == WidgetType::Splash && on != wasOn) showSplash(i, on);
+            if (frameCounts[i] > 1) {
+                float v = value < 0.0f ? 0.0f : value > 1.0f ? 1.0f : value;
+                setFrame(i, (int)(v * (frameCounts[i] - 1) + 0.5f));
+            }
+            if (textIndex[i] >= 0 && formatted[textIndex[i]].update(value)) {
+                texts[textIndex[i]].setText(formatted[textIndex[i]].text.text);
+                touched(i);
+            }
+        }
+    }
+
+    /// advance running tweens; widgets they touch are marked dirty like any other change
+    void animate(uint64_t nowNs) {
+        animator.update(nowNs, [this](uint32_t i, TweenProp prop, float v) {
+            if (prop == TweenProp::Alpha) setAlpha(i, v);
+            else setFrame(i, (int)(v + 0.5f));
+        });
+    }
+
+    /// false when another draw() would show exactly the last frame: nothing
+    /// changed, no tween is running and no art is still on its way in
+    bool needsDraw(Renderer& renderer) {
+        return redraw || animator.active() || signalsChanged() || textureCacheFor(renderer).loading() ||
+               renderer.uploadsPending() || (layerTarget.id && layerScale != renderer.contentScale());
+    }
+
+    /// new samples in any ring, or a meter still falling back
+    bool signalsChanged() const {
+        for (const SignalView& s : signals)
+            if ((s.ring && s.ring->writeCount() != s.seen) || s.stale || s.levelDb > kMeterFloorDb) return true;
+        return false;
+    }
+
+    /// rebuild the quads of meters and scopes that have something new to show
+    void updateSignals(uint64_t nowNs) {
+        const size_t n = size();
+        for (size_t i = 0; i < n; ++i) {
+            if (signalIndex[i] < 0) continue;
+            SignalView& s = signals[signalIndex[i]];
+            const uint64_t end = s.ring ? s.ring->writeCount() : 0;
+            const float dt = s.lastNs ? (float)((nowNs - s.lastNs) * 1e-9) : 0.0f;
+            s.lastNs = nowNs;
+            if (end == s.seen && !s.stale && s.levelDb <= kMeterFloorDb) continue;
+            if (types[i] == WidgetType::Scope) updateScope(i, s, end);
+            else updateMeter(i, s, end, dt);
+            s.stale = false;
+        }
+    }
+
+    /// regenerate quads for dirty widgets from the rect/uv/color arrays
+    void buildQuads() {
+        const size_t n = size();
+        const WidgetRect* r = rects.data();
+        const UVRect* t = uvs.data();
+        const uint32_t* c = colors.data();
+        uint8_t* f = flags.data();
+        Quad* q = quads.data();
+        for (size_t i = 0; i < n; ++i) {
+            if (!(f[i] & kWidgetDirty)) continue;
+            const float x0 = r[i].x, y0 = r[i].y, x1 = r[i].x + r[i].w, y1 = r[i].y + r[i].h;
+            q[i].verts = { x0, y0, x1, y0, x0, y1, x1, y1 };
+            q[i].uvs = { t[i].u0, t[i].v0, t[i].u1, t[i].v0, t[i].u0, t[i].v1, t[i].u1, t[i].v1 };
+            q[i].setColor(c[i]);
+            f[i] &= (uint8_t)~kWidgetDirty;
+        }
+    }
+
+    /// new rect from the layout; text is re-laid out (or just shifted) to match
+    void setRect(size_t i, const WidgetRect& r) {
+        rects[i] = r;
+        flags[i] |= kWidgetDirty;
+        if (textIndex[i] >= 0) texts[textIndex[i]].setRect(r.x, r.y, r.w, r.h);
+        if (signalIndex[i] >= 0) sizeSignal(i);
+        redraw = true;
+        layerStale = true; // what overlaps what may have changed
+    }
+
+    /// window is now w x h points; re-places only what depends on it
+    void resize(float w, float h) {
+        layout.update(w, h, [this](int32_t widget, const WidgetRect& r) { setRect((size_t)widget, r); });
+    }
+
+    /// queue every widget in layout order (the static ones as their layer)
+    void draw(Renderer& renderer) {
+        TextureCache& textures = textureCacheFor(renderer);
+        textures.pump(renderer); // hand finished decodes to the uploader
+        const uint64_t now = profiler::nowNs();
+        animate(now);
+        updateSignals(now);
+        buildQuads();
+        // on a display of another density the old pixels would be drawn stretched
+        if (layerTarget.id && layerScale != renderer.contentScale()) layerStale = true;
+        // never bake placeholders: wait for the art before building the layer
+        if (useLayer && layerStale && !textures.loading() && !renderer.uploadsPending()) buildLayer(renderer);
+
+        const bool layered = layerTarget.id && !layerStale;
+        if (layered) renderer.addQuad(Quad(layerRect.x, layerRect.y, layerRect.w, layerRect.h), layerTarget.id);
+        const size_t n = size();
+        for (size_t i = 0; i < n; ++i) {
+            if (layered && (flags[i] & kWidgetLayered)) continue;
+            if (!(colors[i] >> 24)) continue; // faded out / hidden
+            if (flags[i] & kWidgetHasQuad) renderer.addQuad(quads[i], texIds[i]);
+            if (textIndex[i] >= 0) texts[textIndex[i]].draw(renderer);
+            if (signalIndex[i] >= 0) {
+                const SignalView& s = signals[signalIndex[i]];
+                for (const Quad& q : s.quads) renderer.addQuad(q, s.system->atlas.texId);
+            }
+        }
+        redraw = false;
+    }
+
+    /// free the layer's render target now rather than with the table
+    void releaseLayer() {
+        layerTarget.reset();
+        layerStale = true;
+    }
+
+    /// the panel as it looks now, rendered offscreen at scale (screenshots, preset
+    /// thumbnails): premultiplied RGBA8, top row first.  false if the backend can't
+    bool capture(Renderer& renderer, float width, float height, float scale,
+                 std::vector<uint8_t>& rgba, int& pixelW, int& pixelH) {
+        buildQuads();
+        std::vector<Quad> q;
+        std::vector<unsigned int> t;
+        for (size_t i = 0; i < size(); ++i) appendQuads(i, q, t);
+        for (Quad& quad : q)
+            for (float& v : quad.verts) v *= scale;
+        unsigned int target = renderer.createRenderTarget((int)(width * scale + 0.5f), (int)(height * scale + 0.5f));
+        if (!target) return false;
+        renderer.renderToTarget(target, q.data(), t.data(), q.size());
+        bool ok = renderer.readPixels(target, rgba, pixelW, pixelH);
+        renderer.destroyRenderTarget(target);
+        return ok;
+    }
+
+private:
+    static constexpr size_t kMinLayerWidgets = 2; // below this a layer saves nothing
+
+    // counting sort of the bound widgets by param, so applyParam() visits
+    // only its own widgets instead of scanning the whole table
+    void buildParamIndex() {
+        int32_t maxId = -1;
+        for (int32_t id : paramIds) maxId = std::max(maxId, id);
+        paramStart.assign((size_t)(maxId + 2), 0);
+        for (int32_t id : paramIds)
+            if (id >= 0) ++paramStart[(size_t)id + 1];
+        for (size_t p = 1; p < paramStart.size(); ++p) paramStart[p] += paramStart[p - 1];
+        paramWidgets.resize(paramStart.back());
+        std::vector<uint32_t> next(paramStart.begin(), paramStart.end() - 1);
+        for (size_t i = 0; i < paramIds.size(); ++i)
+            if (paramIds[i] >= 0) paramWidgets[next[(size_t)paramIds[i]]++] = (uint32_t)i;
+        paramIndexStale = false;
+    }
+
+    void touched(size_t i) {
+        redraw = true;
+        if (flags[i] & kWidgetLayered) layerStale = true;
+    }
+
+    // can only change through setRect, i.e. a layout change
+    bool isStatic(size_t i) const {
+        return frameCounts[i] == 1 && signalIndex[i] < 0 && types[i] != WidgetType::Display &&
+               types[i] != WidgetType::KickButton && types[i] != WidgetType::Splash;
+    }
+
+    void appendQuads(size_t i, std::vector<Quad>& q, std::vector<unsigned int>& t) const {
+        if (!(colors[i] >> 24)) return;
+        if (flags[i] & kWidgetHasQuad) { q.push_back(quads[i]); t.push_back(texIds[i]); }
+        if (textIndex[i] >= 0) {
+            const TextBlock& tb = texts[textIndex[i]];
+            for (const Quad& g : tb.quads) { q.push_back(g); t.push_back(tb.system->atlas.texId); }
+        }
+        if (signalIndex[i] >= 0) {
+            const SignalView& s = signals[signalIndex[i]];
+            for (const Quad& g : s.quads) { q.push_back(g); t.push_back(s.system->atlas.texId); }
+        }
+    }
+
+    // the only place a signal widget's buffers grow: one column per point of width
+    void sizeSignal(size_t i) {
+        SignalView& s = signals[signalIndex[i]];
+        const size_t columns = rects[i].w > 1.0f ? (size_t)rects[i].w : 1;
+        s.mins.resize(columns);
+        s.maxs.resize(columns);
+        s.quads.clear();
+        s.quads.reserve(columns + 1);
+        s.stale = true;
+    }
+
+    // one min..max bar per column over the last `window` samples
+    void updateScope(size_t i, SignalView& s, uint64_t end) {
+        const size_t columns = s.mins.size();
+        if (s.ring && !s.ring->read(end, s.window, [&](const float* a, size_t na, const float* b, size_t nb) {
+                minMaxColumns(a, na, b, nb, s.mins.data(), s.maxs.data(), columns);
+            }))
+            return; // overwritten while we looked: keep the last picture, try again next frame
+        if (!s.ring) { // no source: a flat line
+            std::fill(s.mins.begin(), s.mins.end(), 0.0f);
+            std::fill(s.maxs.begin(), s.maxs.end(), 0.0f);
+        }
+        s.seen = end;
+
+        const WidgetRect& r = rects[i];
+        const float half = r.h * 0.5f, mid = r.y + half, cw = r.w / columns;
+        s.quads.clear();
+        if (s.hasBackground) s.quads.push_back(s.system->solidQuad(r.x, r.y, r.w, r.h, s.bgColor));
+        for (size_t c = 0; c < columns; ++c) {
+            const float hi = std::min(1.0f, std::max(-1.0f, s.maxs[c]));
+            const float lo = std::min(1.0f, std::max(-1.0f, s.mins[c]));
+            const float y0 = mid - hi * half, y1 = mid - lo * half;
+            s.quads.push_back(s.system->solidQuad(r.x + c * cw, y0, cw, std::max(1.0f, y1 - y0), s.color));
+        }
+        redraw = true;
+    }
+
+    // peak of everything written since the last frame, held against a steady fall
+    void updateMeter(size_t i, SignalView& s, uint64_t end, float dt) {
+        float mn = 0.0f, mx = 0.0f;
+        // a lapped read is still a mix of recent samples, good enough for a peak
+        if (s.ring && end != s.seen)
+            s.ring->read(end, (size_t)std::min<uint64_t>(end - s.seen, s.ring->capacity()),
+                         [&](const float* a, size_t na, const float* b, size_t nb) {
+                minMax(a, na, mn, mx);
+                minMax(b, nb, mn, mx);
+            });
+        s.seen = end;
+        const float peak = std::max(-mn, mx);
+        const float db = peak > 0.0f ? 20.0f * std::log10(peak) : kMeterFloorDb;
+        const float level = std::max(kMeterFloorDb, std::max(db, s.levelDb - kMeterFallDbPerSecond * dt));
+        if (level == s.levelDb && !s.stale) return;
+        s.levelDb = level;
+
+        const WidgetRect& r = rects[i];
+        const float f = std::min(1.0f, (level - kMeterFloorDb) / -kMeterFloorDb);
+        s.quads.clear();
+        if (s.hasBackground) s.quads.push_back(s.system->solidQuad(r.x, r.y, r.w, r.h, s.bgColor));
+        if (f > 0.0f) {
+            if (orientations[i] == FilmstripOrientation::Horizontal)
+                s.quads.push_back(s.system->solidQuad(r.x, r.y, r.w * f, r.h, s.color)); // fills from the left
+            else
+                s.quads.push_back(s.system->solidQuad(r.x, r.y + r.h * (1.0f - f), r.w, r.h * f, s.color)); // from the bottom
+        }
+        redraw = true;
+    }
+
+    static void grow(WidgetRect& b, const Quad& q) {
+        for (int k = 0; k < 4; ++k) {
+            float x = q.verts[k * 2], y = q.verts[k * 2 + 1];
+            if (b.w < 0) { b = { x, y, 0, 0 }; continue; }
+            if (x < b.x) { b.w += b.x - x; b.x = x; } else if (x > b.x + b.w) b.w = x - b.x;
+            if (y < b.y) { b.h += b.y - y; b.y = y; } else if (y > b.y + b.h) b.h = y - b.y;
+        }
+    }
+
+    static bool overlaps(const WidgetRect& a, const WidgetRect& b) {
+        return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+    }
+
+    // a static widget with nothing per-frame drawn under it can sink to the
+    // bottom of the stack without changing the picture; those go in the layer
+    void buildLayer(Renderer& renderer) {
+        std::vector<Quad> q;
+        std::vector<unsigned int> t;
+        std::vector<WidgetRect> above; // screen area of everything drawn per frame so far
+        WidgetRect bounds{ 0, 0, -1, -1 };
+        size_t members = 0;
+        for (size_t i = 0; i < size(); ++i) {
+            flags[i] &= (uint8_t)~kWidgetLayered;
+            const size_t first = q.size();
+            appendQuads(i, q, t);
+            const bool fixed = isStatic(i);
+            if (fixed && q.size() == first) continue; // hidden; setAlpha() rebuilds if that changes
+            // a per-frame widget occludes even while it draws nothing (a hidden
+            // splash): it can show up any frame without the layer being rebuilt
+            WidgetRect area = fixed ? WidgetRect{ 0, 0, -1, -1 } : rects[i];
+            for (size_t k = first; k < q.size(); ++k) grow(area, q[k]);
+            bool sinks = fixed;
+            for (size_t k = 0; sinks && k < above.size(); ++k) sinks = !overlaps(area, above[k]);
+            if (!sinks) {
+                above.push_back(area);
+                q.resize(first);
+                t.resize(first);
+                continue;
+            }
+            flags[i] |= kWidgetLayered;
+            for (size_t k = first; k < q.size(); ++k) grow(bounds, q[k]);
+            ++members;
+        }
+        if (members < kMinLayerWidgets) {
+            for (uint8_t& f : flags) f &= (uint8_t)~kWidgetLayered;
+            releaseLayer();
+            layerStale = false; // nothing to build until something changes
+            return;
+        }
+
+        // whole points, so glyphs and 1:1 art stay on the pixel grid
+        const float x0 = std::floor(bounds.x), y0 = std::floor(bounds.y);
+        const int w = (int)std::ceil(bounds.x + bounds.w - x0), h = (int)std::ceil(bounds.y + bounds.h - y0);
+        const float scale = renderer.contentScale();
+        if (!layerTarget.id || (int)layerRect.w != w || (int)layerRect.h != h || layerScale != scale) {
+            releaseLayer();
+            layerTarget = OwnedRenderTarget(renderer, renderer.createRenderTarget(w, h));
+            layerScale = scale;
+            if (!layerTarget.id) { // backend can't: draw everything directly from now on
+                useLayer = false;
+                for (uint8_t& f : flags) f &= (uint8_t)~kWidgetLayered;
+                return;
+            }
+        }
+        layerRect = { x0, y0, (float)w, (float)h };
+        for (Quad& quad : q)
+            for (int k = 0; k < 4; ++k) { quad.verts[k * 2] -= x0; quad.verts[k * 2 + 1] -= y0; }
+        renderer.renderToTarget(layerTarget.id, q.data(), t.data(), q.size());
+        layerStale = false;
+    }
+
+    static constexpr float kKickSeconds = 0.15f;
+    static constexpr float kFadeSeconds = 0.2f;
+
+    // momentary button fired: pressed look, easing back to rest
+    void kick(size_t i) {
+        const uint64_t now = profiler::nowNs();
+        if (frameCounts[i] > 1) animator.start(now, (uint32_t)i, TweenProp::Frame, float(frameCounts[i] - 1), 0.0f, kKickSeconds, Ease::Out);
+        else animator.start(now, (uint32_t)i, TweenProp::Alpha, 0.5f, 1.0f, kKickSeconds, Ease::Out);
+    }
+
+    // shown at once; with a timeout it fades out on its own afterwards
+    void showSplash(size_t i, bool on) {
+        animator.stop((uint32_t)i);
+        setAlpha(i, on ? 1.0f : 0.0f);
+        if (on && timeoutsMs[i])
+            animator.start(profiler::nowNs(), (uint32_t)i, TweenProp::Alpha, 1.0f, 0.0f, kFadeSeconds, Ease::In,
+                           timeoutsMs[i] * 0.001f);
+    }
+
+    size_t push(WidgetType type, float x, float y, float w, float h) {
+        rects.push_back({ x, y, w, h });
+        uvs.push_back({ 0.0f, 0.0f, 1.0f, 1.0f });
+        colors.push_back(0xFFFFFFFF);
+        texIds.push_back(0);
+        paramIds.push_back(-1);
+        flags.push_back(kWidgetDirty);
+        types.push_back(type);
+        frameCounts.push_back(1);
+        frames.push_back(0);
+        orientations.push_back(FilmstripOrientation::Vertical);
+        values.push_back(0.0f);
+        quads.emplace_back();
+        textIndex.push_back(-1);
+        timeoutsMs.push_back(0);
+        signalIndex.push_back(-1);
+        return rects.size() - 1;
+    }
+};
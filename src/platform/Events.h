@@ -1,6 +1,8 @@
 #pragma once
 #include <vector>
 #include <map>
+#include <chrono>
+#include <cstdint>
 
 enum class EventType {
     Quit,
@@ -28,6 +30,7 @@ struct Event {
     char character{0};           // normalized ASCII/UTF-8 character for the key
     bool keyRepeat{false}; // true if KeyDown is a repeat
     MouseButton button{MouseButton::Unknown}; // which mouse button
+    uint64_t timeNs{0};    // steady_clock ns when it was dispatched (see Renderer::noteInput)
     bool isPrintableKey() const { return character >= 32 && character <= 126; }
 };
 
@@ -78,7 +81,11 @@ public:
     listeners.push_back(listener);
   }
 
-  void dispatch(const Event& e) {
+  void dispatch(const Event& event) {
+    Event e = event;
+    if (!e.timeNs)
+      e.timeNs = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch()).count();
     for (auto* l : listeners) l->onEvent(e);
   }
 
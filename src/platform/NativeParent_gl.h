@@ -14,11 +14,25 @@ struct NativeParent {
 #endif
 };
 
-/// Creates a GL context bound to the native window (NSOpenGLContext)
-uint64_t makeSurface(NativeParent parent, int width, int height);
+/// Creates a GL context bound to the native window (NSOpenGLContext).
+/// shareWith (0 = none) puts it in that context's share group, so textures,
+/// buffers and programs created in either are usable in both
+uint64_t makeSurface(NativeParent parent, int width, int height, uint64_t shareWith = 0);
+
+/// device pixels per point of the window (2 on Retina, 1 elsewhere)
+float backingScaleFactor(NativeParent parent);
+
+/// refresh rate of the display the window is on, in Hz (60 if unknown)
+float displayRefreshRate(NativeParent parent);
+
+/// 1 = wait for vsync, 0 = swap immediately (may tear)
+void setSwapInterval(uint64_t ctx, int interval);
 
 /// Make this GL context current
 void makeCurrent(uint64_t ctx);
 
+/// Release the calling thread's current context, so another thread can take it
+void clearCurrentContext();
+
 /// Swap buffers (present)
 void swapBuffers(uint64_t ctx);
@@ -4,7 +4,7 @@
 #import <Cocoa/Cocoa.h>
 #import <OpenGL/gl3.h>
 
-uint64_t makeSurface(NativeParent parent, int width, int height) {
+uint64_t makeSurface(NativeParent parent, int width, int height, uint64_t shareWith) {
     NSWindow* window = (__bridge NSWindow*)parent.nsWindow;
 
     NSOpenGLPixelFormatAttribute attrs[] = {
@@ -16,10 +16,12 @@ uint64_t makeSurface(NativeParent parent, int width, int height) {
     };
 
     NSOpenGLPixelFormat* pixelFormat = [[NSOpenGLPixelFormat alloc] initWithAttributes:attrs];
+    NSOpenGLContext* share = shareWith ? (__bridge NSOpenGLContext*)(void*)shareWith : nil;
     NSOpenGLContext* context = [[NSOpenGLContext alloc] initWithFormat:pixelFormat
-                                                          shareContext:nil];
+                                                          shareContext:share];
 
     NSView* contentView = [window contentView];
+    [contentView setWantsBestResolutionOpenGLSurface:YES]; // full-res backbuffer on Retina
     [context setView:contentView];
     [context makeCurrentContext];
 
@@ -27,12 +29,35 @@ uint64_t makeSurface(NativeParent parent, int width, int height) {
     return reinterpret_cast<uint64_t>(context);
 }
 
+float backingScaleFactor(NativeParent parent) {
+    NSWindow* window = (__bridge NSWindow*)parent.nsWindow;
+    return window ? (float)[window backingScaleFactor] : 1.0f;
+}
+
+float displayRefreshRate(NativeParent parent) {
+    NSWindow* window = (__bridge NSWindow*)parent.nsWindow;
+    if (@available(macOS 12.0, *)) {
+        NSScreen* screen = window ? [window screen] : [NSScreen mainScreen];
+        if (screen && [screen maximumFramesPerSecond] > 0) return (float)[screen maximumFramesPerSecond];
+    }
+    return 60.0f;
+}
+
+void setSwapInterval(uint64_t ctx, int interval) {
+    NSOpenGLContext* context = (__bridge NSOpenGLContext*)(void*)ctx;
+    GLint value = interval;
+    [context setValues:&value forParameter:NSOpenGLContextParameterSwapInterval];
+}
 
 void makeCurrent(uint64_t ctx) {
     NSOpenGLContext* context = (__bridge NSOpenGLContext*)(void*)ctx;
     [context makeCurrentContext];
 }
 
+void clearCurrentContext() {
+    [NSOpenGLContext clearCurrentContext];
+}
+
 void swapBuffers(uint64_t ctx) {
     NSOpenGLContext* context = (__bridge NSOpenGLContext*)(void*)ctx;
     [context flushBuffer];
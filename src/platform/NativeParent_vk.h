@@ -4,6 +4,9 @@
 #define VKSURFFROMNATIVE_H
 
 #include <vulkan/vulkan.h>
+#if !defined(_WIN32) && !defined(__APPLE__)
+#include <X11/Xlib.h>
+#endif
 
 
 // vk_surface_from_native.h
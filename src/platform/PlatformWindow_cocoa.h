@@ -27,6 +27,7 @@ struct PlatformWindow {
     NativeParent& nativeParent();
 
     void poll();
+    void waitEvents(double timeoutSeconds); // block until an event arrives or the timeout passes, then poll()
     bool shouldClose();
     void* nsView();  // returns NSView* as opaque void* for Vulkan surface creation
 
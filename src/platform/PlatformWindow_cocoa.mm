@@ -167,6 +167,15 @@ void PlatformWindow::poll() {
     [NSApp updateWindows];
 }
 
+void PlatformWindow::waitEvents(double timeoutSeconds) {
+    NSEvent* event = [NSApp nextEventMatchingMask:NSEventMaskAny
+                                        untilDate:[NSDate dateWithTimeIntervalSinceNow:timeoutSeconds]
+                                           inMode:NSDefaultRunLoopMode
+                                          dequeue:YES];
+    if (event) [NSApp sendEvent:event];
+    poll();
+}
+
 bool PlatformWindow::shouldClose() {
     GfxWindowDelegate* del = (GfxWindowDelegate*)[window delegate];
     return del.shouldClose;
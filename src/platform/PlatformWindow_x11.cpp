@@ -1,10 +1,15 @@
+#include <X11/Xlib.h>
+#include <vulkan/vulkan.h>
+#include <vulkan/vulkan_xlib.h>
+#include "NativeParent_vk.h"
+#include <stdexcept>
 
 VkSurfaceKHR makeSurface(VkInstance inst, const NativeParent& np){
   VkSurfaceKHR surface{};
   VkXlibSurfaceCreateInfoKHR ci{VK_STRUCTURE_TYPE_XLIB_SURFACE_CREATE_INFO_KHR};
   ci.dpy = np.dpy;
   ci.window = np.win;
-  vkCreateXlibSurfaceKHR(inst, &ci, nullptr, &surface);
-
+  if (vkCreateXlibSurfaceKHR(inst, &ci, nullptr, &surface) != VK_SUCCESS)
+      throw std::runtime_error("Failed to create Xlib surface");
   return surface;
 }
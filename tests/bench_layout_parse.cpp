@@ -0,0 +1,153 @@
+// bench_layout_parse: time to get a LayoutDesc from the JSON versus from the
+// pre-parsed .layout.bin (see layout.h), including reading the file.
+//
+//   bench_layout_parse [controls] [rounds]         (default 2000, 100)
+//   bench_layout_parse --layout file.json [rounds]
+//
+// By default a layout of `controls` controls is generated (knobs, buttons,
+// displays and labels with named and inline colors) and written to the
+// working directory with its binary.  Both are then loaded `rounds` times
+// and the medians printed.  The two results must describe the same
+// controls, so a binary that drifted from the parser fails the test.
+
+#include "layout.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace layout_detail;
+
+static std::string generate(int controls) {
+    std::string s = "{\n  \"colors\": { \"grey\": [160, 160, 160], \"textBG\": [20, 20, 24, 255] },\n  \"controls\": [\n";
+    char buf[512];
+    for (int i = 0; i < controls; ++i) {
+        const int x = (i % 40) * 48, y = (i / 40) * 48;
+        switch (i % 4) {
+        case 0:
+            snprintf(buf, sizeof(buf),
+                     "    { \"type\": \"knob\", \"param\": \"kParam%d\", \"label\": \"Knob %d\", \"pos\": [%d, %d], "
+                     "\"texture\": \"knob.png\", \"frames\": 64 }", i / 4, i, x, y);
+            break;
+        case 1:
+            snprintf(buf, sizeof(buf),
+                     "    { \"type\": \"button\", \"param\": \"kParam%d\", \"label\": \"Button %d\", \"pos\": [%d, %d], "
+                     "\"texture\": \"button.png\", \"frames\": 2, \"anchor\": \"bottom-right\" }", i / 4, i, x, y);
+            break;
+        case 2:
+            snprintf(buf, sizeof(buf),
+                     "    { \"type\": \"display\", \"param\": \"kParam%d\", \"label\": \"Display %d\", \"pos\": [%d, %d], "
+                     "\"size\": [40, 14], \"text_color\": \"grey\", \"bg_color\": \"textBG\", \"align\": \"right\" }", i / 4, i, x, y);
+            break;
+        default:
+            snprintf(buf, sizeof(buf),
+                     "    { \"type\": \"label\", \"label\": \"Label %d\", \"text\": \"caption \\\"%d\\\"\", \"pos\": [%d, %d], "
+                     "\"size\": [40, 12], \"text_color\": [230, 230, 230] }", i, i, x, y);
+            break;
+        }
+        s += buf;
+        s += i + 1 < controls ? ",\n" : "\n";
+    }
+    s += "  ]\n}\n";
+    return s;
+}
+
+static bool sameColor(const ColorRef& a, const ColorRef& b) { return a.set == b.set && a.value == b.value; }
+
+static bool sameControls(const LayoutDesc& a, const LayoutDesc& b) {
+    if (a.controls.size() != b.controls.size()) return false;
+    for (size_t i = 0; i < a.controls.size(); ++i) {
+        const ControlDesc& x = a.controls[i];
+        const ControlDesc& y = b.controls[i];
+        if (x.type != y.type || x.label != y.label || x.param != y.param || x.text != y.text ||
+            x.texture != y.texture || x.align != y.align || x.x != y.x || x.y != y.y || x.w != y.w || x.h != y.h ||
+            x.hasSize != y.hasSize || x.frames != y.frames || x.anchorX != y.anchorX || x.anchorY != y.anchorY ||
+            !sameColor(x.textColor, y.textColor) || !sameColor(x.bgColor, y.bgColor) || !sameColor(x.color, y.color)) {
+            printf("FAIL: control #%zu differs between the JSON and the binary\n", i);
+            return false;
+        }
+    }
+    return true;
+}
+
+static double median(std::vector<double>& v) {
+    std::sort(v.begin(), v.end());
+    return v[v.size() / 2];
+}
+
+// what loadLayout() does on the JSON path: map, copy (the parser decodes in place), parse
+static bool loadJson(const std::string& path, LayoutDesc& out) {
+    size_t size = 0;
+    std::shared_ptr<void> file = mapFile(path, size);
+    if (!file) return false;
+    std::shared_ptr<char> text(new char[size], std::default_delete<char[]>());
+    memcpy(text.get(), file.get(), size);
+    if (!parseLayoutJson(text.get(), size, out, path.c_str())) return false;
+    out.storage = text;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::string jsonPath = "bench_layout.json";
+    int controls = 2000, rounds = 100;
+    if (argc > 2 && strcmp(argv[1], "--layout") == 0) {
+        jsonPath = argv[2];
+        controls = 0;
+        if (argc > 3) rounds = atoi(argv[3]);
+    } else {
+        if (argc > 1) controls = atoi(argv[1]);
+        if (argc > 2) rounds = atoi(argv[2]);
+    }
+    rounds = std::max(1, rounds);
+
+    if (controls > 0) {
+        const std::string text = generate(controls);
+        FILE* fp = fopen(jsonPath.c_str(), "wb");
+        if (!fp || fwrite(text.data(), 1, text.size(), fp) != text.size()) {
+            printf("ERROR: can't write %s\n", jsonPath.c_str());
+            if (fp) fclose(fp);
+            return 1;
+        }
+        fclose(fp);
+    }
+
+    LayoutDesc fromJson, fromBin;
+    if (!loadJson(jsonPath, fromJson)) return 1;
+    // a layout given with --layout keeps its own .layout.bin: the bench one has no real stamp
+    const std::string binPath = controls > 0 ? layoutBinaryPath(jsonPath) : "bench_layout.layout.bin";
+    if (!writeBinary(binPath, SourceStamp{ 0, 0, 0 }, fromJson)) {
+        printf("ERROR: can't write %s\n", binPath.c_str());
+        return 1;
+    }
+    auto always = [](const SourceStamp&) { return true; };
+    if (!readBinary(binPath, always, fromBin) || !sameControls(fromJson, fromBin)) {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    std::vector<double> json, bin;
+    for (int r = 0; r < rounds; ++r) {
+        LayoutDesc a, b;
+        uint64_t t0 = profiler::nowNs();
+        loadJson(jsonPath, a);
+        uint64_t t1 = profiler::nowNs();
+        readBinary(binPath, always, b);
+        uint64_t t2 = profiler::nowNs();
+        json.push_back((t1 - t0) * 1e-3);
+        bin.push_back((t2 - t1) * 1e-3);
+    }
+
+    size_t jsonBytes = 0, binBytes = 0;
+    mapFile(jsonPath, jsonBytes);
+    mapFile(binPath, binBytes);
+    const double j = median(json), b = median(bin);
+    printf("%s: %zu controls, %d rounds\n", jsonPath.c_str(), fromJson.controls.size(), rounds);
+    printf("json         %8zu bytes  median %9.1f us\n", jsonBytes, j);
+    printf("layout.bin   %8zu bytes  median %9.1f us  (%.1fx)\n", binBytes, b, b > 0.0 ? j / b : 0.0);
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,123 @@
+// bench_present: frame latency and jitter for every render mode and present
+// policy, on this machine's display.  Needs a window, so ctest doesn't run it.
+//
+//   bench_present [layout.json] [frames]   (default def.json, 900)
+//
+// For each RenderMode a window is opened, then every policy the device
+// supports is run for `frames` frames of a knob being turned: one param
+// changes per frame and noteInput() stamps it like a mouse move would.  With
+// profiling on, the renderer prints submit->present, input->present and
+// present interval (sd = jitter) every 300 frames; at the end a table sums
+// up what the caller's loop saw: time blocked in drawFrame() and the
+// interval between its frames.
+
+#include <guikit.h>
+#include "profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+static constexpr int kWidth = 800, kHeight = 600;
+static constexpr int kMaxLoadFrames = 600; // art streams in before timing starts
+static constexpr int kReportEvery = 300;   // the renderer's profile interval, so no report spans two policies
+
+struct Result {
+    std::string name;
+    double blockedP50, blockedP99;  // ms inside drawFrame()
+    double intervalP50, intervalSd; // ms between the caller's frames
+};
+
+static const char* modeName(RenderMode mode) {
+    return mode == RenderMode::RenderThread ? "render thread" : "caller thread";
+}
+
+static const char* policyName(PresentPolicy policy) {
+    switch (policy) {
+    case PresentPolicy::PowerSaving: return "power-saving";
+    case PresentPolicy::Adaptive:    return "adaptive";
+    case PresentPolicy::LowLatency:  return "low-latency";
+    }
+    return "?";
+}
+
+static double percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, (size_t)(p * (double)v.size()))];
+}
+
+static Result run(PlatformWindow& win, Renderer& renderer, WidgetTable& widgets, PresentPolicy policy, int frames) {
+    Result r;
+    r.name = std::string(modeName(renderer.renderMode())) + " / " + policyName(policy);
+    printf("=== %s ===\n", r.name.c_str());
+    renderer.setPresentPolicy(policy);
+
+    std::vector<double> blocked, interval;
+    blocked.reserve(frames);
+    interval.reserve(frames);
+    uint64_t last = 0;
+    for (int f = 0; f < frames; ++f) {
+        win.poll();
+        // a knob being turned: one param per frame, answering an input event
+        const uint64_t now = profiler::nowNs();
+        renderer.noteInput(now);
+        widgets.applyParam((int32_t)((uint32_t)f % kParamCount), 0.5f + 0.5f * std::sin(f * 0.05f));
+        widgets.draw(renderer);
+
+        const uint64_t t0 = profiler::nowNs();
+        renderer.drawFrame();
+        const uint64_t t1 = profiler::nowNs();
+        blocked.push_back((t1 - t0) * 1e-6);
+        if (last) interval.push_back((t1 - last) * 1e-6);
+        last = t1;
+    }
+
+    double mean = 0.0, sq = 0.0;
+    for (double v : interval) mean += v;
+    mean /= interval.empty() ? 1.0 : (double)interval.size();
+    for (double v : interval) sq += (v - mean) * (v - mean);
+    r.blockedP50 = percentile(blocked, 0.5);
+    r.blockedP99 = percentile(blocked, 0.99);
+    r.intervalP50 = percentile(interval, 0.5);
+    r.intervalSd = interval.size() > 1 ? std::sqrt(sq / (double)(interval.size() - 1)) : 0.0;
+    return r;
+}
+
+int main(int argc, char** argv) {
+    const char* layout = argc > 1 ? argv[1] : "def.json";
+    int frames = argc > 2 ? atoi(argv[2]) : 900;
+    frames = std::max(1, (frames + kReportEvery - 1) / kReportEvery) * kReportEvery;
+
+    std::vector<Result> results;
+    for (RenderMode mode : { RenderMode::CallerThread, RenderMode::RenderThread }) {
+        // one window per mode: the first Renderer of a share group picks it
+        PlatformWindow win(kWidth, kHeight, "bench_present");
+        Renderer renderer(win.nativeParent(), kWidth, kHeight, mode);
+        if (renderer.renderMode() != mode) {
+            printf("NOTE: %s isn't available here\n", modeName(mode));
+            continue;
+        }
+        WidgetTable widgets = loadGUI(renderer, layout);
+        widgets.resize((float)kWidth, (float)kHeight);
+        for (int f = 0; f < kMaxLoadFrames && (textureCacheFor(renderer).loading() || renderer.uploadsPending()); ++f) {
+            win.poll();
+            widgets.draw(renderer);
+            renderer.drawFrame();
+        }
+
+        renderer.setProfiling(true);
+        for (PresentPolicy policy : renderer.supportedPresentPolicies())
+            results.push_back(run(win, renderer, widgets, policy, frames));
+        renderer.setProfiling(false);
+    }
+
+    printf("\n%-32s %22s %26s\n", "", "drawFrame() p50 / p99", "caller interval p50 / sd");
+    for (const Result& r : results)
+        printf("%-32s %9.3f / %7.3f ms %13.3f / %7.3f ms\n",
+               r.name.c_str(), r.blockedP50, r.blockedP99, r.intervalP50, r.intervalSd);
+    return 0;
+}
@@ -0,0 +1,101 @@
+// bench_widget_table: the per-change and per-frame cost of a 10k-control
+// WidgetTable, without a window or a GPU.
+//
+//   bench_widget_table [controls] [rounds]   (default 10000, 200)
+//
+// Measures, median over the rounds:
+//   sweep   - applyParam() for every param once (a preset load), then buildQuads()
+//   sparse  - 16 params change (automation in a typical frame), then buildQuads()
+//   idle    - buildQuads() with nothing dirty
+// and checks every knob landed on the frame its value asks for, so a broken
+// param -> widget index fails the test instead of just running fast.
+
+#include "widget_table.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static constexpr int kKnobFrames = 64;
+
+// knobs, two-frame buttons sharing a knob's param and unbound label art:
+// roughly the mix of a large synth panel
+static void buildPanel(WidgetTable& widgets, size_t controls, int32_t& params) {
+    widgets.reserve(controls);
+    widgets.addQuadWidget(WidgetType::Background, 0, 0, 4000, 4000, 3);
+    params = 0;
+    for (size_t i = 1; i < controls; ++i) {
+        const float x = float(i % 100) * 40.0f, y = float(i / 100) * 40.0f;
+        if (i % 5 == 4) {
+            widgets.addQuadWidget(WidgetType::Label, x, y, 32, 12, 4);
+        } else if (i % 5 == 3) {
+            size_t w = widgets.addQuadWidget(WidgetType::Button, x, y, 32, 64, 2, 2);
+            widgets.bindParam(w, params - 1); // the button shares the knob's param
+        } else {
+            size_t w = widgets.addQuadWidget(WidgetType::Knob, x, y, 32, 32 * kKnobFrames, 1, kKnobFrames);
+            widgets.bindParam(w, params++);
+        }
+    }
+}
+
+static double median(std::vector<double>& v) {
+    std::sort(v.begin(), v.end());
+    return v[v.size() / 2];
+}
+
+int main(int argc, char** argv) {
+    const size_t controls = argc > 1 ? (size_t)atoi(argv[1]) : 10000;
+    const int rounds = argc > 2 ? atoi(argv[2]) : 200;
+
+    WidgetTable widgets;
+    int32_t params = 0;
+    buildPanel(widgets, controls, params);
+    widgets.buildQuads();
+
+    std::vector<double> sweep, sparse, idle;
+    uint32_t seed = 1;
+    for (int r = 0; r < rounds; ++r) {
+        const float base = float(r % 16) / 16.0f;
+        uint64_t t0 = profiler::nowNs();
+        for (int32_t p = 0; p < params; ++p)
+            widgets.applyParam(p, base + float(p % 7) / 112.0f);
+        widgets.buildQuads();
+        uint64_t t1 = profiler::nowNs();
+        sweep.push_back((t1 - t0) * 1e-3);
+
+        t0 = profiler::nowNs();
+        for (int k = 0; k < 16; ++k) {
+            seed = seed * 1664525u + 1013904223u;
+            widgets.applyParam((int32_t)(seed % (uint32_t)params), float(seed >> 8 & 0xFF) / 255.0f);
+        }
+        widgets.buildQuads();
+        t1 = profiler::nowNs();
+        sparse.push_back((t1 - t0) * 1e-3);
+
+        t0 = profiler::nowNs();
+        widgets.buildQuads();
+        t1 = profiler::nowNs();
+        idle.push_back((t1 - t0) * 1e-3);
+    }
+
+    // one last sweep with known values, then every bound widget must show them
+    for (int32_t p = 0; p < params; ++p) widgets.applyParam(p, float(p % kKnobFrames) / (kKnobFrames - 1));
+    widgets.buildQuads();
+    int bad = 0;
+    for (size_t i = 0; i < widgets.size(); ++i) {
+        const int32_t p = widgets.paramIds[i];
+        if (p < 0) continue;
+        const int want = widgets.frameCounts[i] == kKnobFrames ? p % kKnobFrames
+                                                               : (p % kKnobFrames) * 2 >= kKnobFrames - 1 ? 1 : 0;
+        if (widgets.frames[i] != want && bad++ < 10)
+            printf("FAIL: widget %zu (param %d) shows frame %d, expected %d\n", i, p, widgets.frames[i], want);
+    }
+
+    printf("%zu controls, %d params, %d rounds\n", widgets.size(), params, rounds);
+    printf("sweep  (all params + buildQuads): %9.1f us\n", median(sweep));
+    printf("sparse (16 params + buildQuads):  %9.1f us\n", median(sparse));
+    printf("idle   (buildQuads only):         %9.1f us\n", median(idle));
+    printf("%s\n", bad ? "FAILED" : "ok");
+    return bad ? 1 : 0;
+}
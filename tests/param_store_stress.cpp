@@ -0,0 +1,139 @@
+// param_store_stress: the processor and GUI sides of ParamStore hammered
+// from two threads at full rate.  Built with -fsanitize=thread where the
+// compiler has it, so a data race fails the test as well as a wrong value.
+//
+//   param_store_stress [seconds]   (default 1)
+//
+// Checks:
+//   - the raw SpscQueue hands over an unbroken 0, 1, 2, ... sequence
+//   - no lost state, in both directions: after both threads stop, the
+//     consumer has seen the last value written to every param.  The queues
+//     are small, so overflow and its resync are part of that
+
+#include "param_store.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+static constexpr uint32_t kParams = 128;
+static constexpr uint32_t kGuiParams = kParams / 2; // GUI edits 0..63, the processor 64..127
+// small queues overflow often, which exercises the resync path too
+using Store = ParamStore<kParams, 64>;
+
+static int failures = 0;
+
+static void fail(const char* what, uint32_t id, float got, float want) {
+    if (failures++ < 10) printf("FAIL: %s: param %u got %.0f, expected %.0f\n", what, id, got, want);
+}
+
+static bool queueOrder(double seconds) {
+    SpscQueue<uint64_t, 256> queue;
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> pushed{0};
+    std::thread producer([&] {
+        uint64_t next = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            if (queue.push(next)) ++next;
+            else std::this_thread::yield();
+        }
+        pushed.store(next, std::memory_order_release);
+    });
+
+    uint64_t expect = 0, got = 0;
+    bool ok = true;
+    const auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+    while (std::chrono::steady_clock::now() < end) {
+        if (!queue.pop(got)) {
+            std::this_thread::yield(); // lets the producer in on a single core
+            continue;
+        }
+        if (got != expect++) ok = false;
+    }
+    stop.store(true);
+    producer.join();
+    while (queue.pop(got))
+        if (got != expect++) ok = false;
+    ok = ok && expect == pushed.load(std::memory_order_acquire);
+    printf("SpscQueue: %llu items in order: %s\n", (unsigned long long)expect, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    const double seconds = argc > 1 ? atof(argv[1]) : 1.0;
+    bool ok = queueOrder(seconds * 0.25);
+
+    Store store;
+    std::atomic<bool> stop{false};
+    std::vector<float> audioLastWritten(kParams, 0.0f); // audio thread's, read after join
+    std::vector<float> audioSeen(kParams, 0.0f);        // latest GUI edit the processor applied
+    uint64_t audioSets = 0, audioDrained = 0;
+
+    // the "audio thread": apply GUI edits, publish automation, never block
+    std::thread audio([&] {
+        float counter = 0.0f;
+        uint32_t id = kGuiParams;
+        while (!stop.load(std::memory_order_relaxed)) {
+            store.processorDrain([&](uint32_t pid, float value) {
+                ++audioDrained;
+                if (pid < kGuiParams) audioSeen[pid] = value; // a resync replays its own params too
+            });
+            counter += 1.0f;
+            if (counter > 1.0e7f) counter = 1.0f; // stays exact in a float
+            store.processorSet(id, counter);
+            audioLastWritten[id] = counter;
+            ++audioSets;
+            if (++id == kParams) id = kGuiParams;
+        }
+    });
+
+    // the GUI thread: user edits out, automation in through the dirty bitset
+    std::vector<float> guiLastWritten(kParams, 0.0f);
+    std::vector<float> guiSeen(kParams, 0.0f);
+    uint64_t guiSets = 0, guiApplied = 0;
+    float counter = 0.0f;
+    uint32_t id = 0;
+    auto consume = [&] {
+        store.guiPoll();
+        store.consumeDirty([&](uint32_t pid, float value) {
+            ++guiApplied;
+            if (pid >= kGuiParams) guiSeen[pid] = value;
+        });
+    };
+    const auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds * 0.75);
+    while (std::chrono::steady_clock::now() < end) {
+        for (int i = 0; i < 256; ++i) {
+            counter += 1.0f;
+            if (counter > 1.0e7f) counter = 1.0f;
+            store.guiSet(id, counter);
+            guiLastWritten[id] = counter;
+            ++guiSets;
+            if (++id == kGuiParams) id = 0;
+        }
+        consume();
+    }
+    stop.store(true);
+    audio.join();
+
+    // both sides quiet: one more pass each must leave them in sync
+    consume();
+    store.processorDrain([&](uint32_t pid, float value) {
+        if (pid < kGuiParams) audioSeen[pid] = value;
+    });
+    for (uint32_t p = 0; p < kGuiParams; ++p)
+        if (guiLastWritten[p] != 0.0f && audioSeen[p] != guiLastWritten[p])
+            fail("processor missed a GUI edit", p, audioSeen[p], guiLastWritten[p]);
+    for (uint32_t p = kGuiParams; p < kParams; ++p)
+        if (audioLastWritten[p] != 0.0f && guiSeen[p] != audioLastWritten[p])
+            fail("GUI missed automation", p, guiSeen[p], audioLastWritten[p]);
+
+    printf("GUI: %llu edits, %llu dirty callbacks; processor: %llu automation writes, %llu drained\n",
+           (unsigned long long)guiSets, (unsigned long long)guiApplied,
+           (unsigned long long)audioSets, (unsigned long long)audioDrained);
+    ok = ok && failures == 0;
+    printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
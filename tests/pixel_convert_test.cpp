@@ -0,0 +1,126 @@
+// pixel_convert_test: convertPixels() must match convertPixelsScalar() byte
+// for byte, for every PixelFormat, with and without premultiplication.
+//
+// Built natively (SSE2 on x86, NEON on ARM) and with SUBA_SIMD_SCALAR, like
+// quad_batch_test.  Covers:
+//   - every (color, alpha) byte pair, so alpha 0 and 255 and every rounding case
+//   - every pixel count from 0 to 67: the vector loops take 4 (SSE2) or 8 (NEON)
+//     pixels at a time, so these hit each tail length several times
+//   - odd image widths, converted as whole images and row by row
+//   - mulDiv255 against exact rounding
+// The buffer starts one byte off alignment and is fenced by guard bytes.
+
+#include "pixel_convert.h"
+#include "simd.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#if SUBA_SIMD_SSE2
+static const char* kPath = "sse2";
+#elif SUBA_SIMD_NEON
+static const char* kPath = "neon";
+#else
+static const char* kPath = "scalar";
+#endif
+
+static const PixelFormat kFormats[] = { PixelFormat::RGBA8, PixelFormat::BGRA8 };
+
+// no default: a new PixelFormat warns here (-Wswitch) until it's added to kFormats
+static const char* formatName(PixelFormat f) {
+    switch (f) {
+    case PixelFormat::RGBA8: return "RGBA8";
+    case PixelFormat::BGRA8: return "BGRA8";
+    }
+    return "?";
+}
+
+static uint32_t seed = 777;
+static uint8_t nextByte() {
+    seed = seed * 1664525u + 1013904223u;
+    return (uint8_t)(seed >> 24);
+}
+
+static int failures = 0;
+
+static constexpr size_t kGuard = 16;
+
+// converts a copy of src both ways, at an odd address, rowWidth pixels per call
+static void check(const std::vector<uint8_t>& src, size_t rowWidth, PixelFormat f, bool premultiply, const char* what) {
+    const size_t pixels = src.size() / 4;
+    std::vector<uint8_t> want(src);
+    std::vector<uint8_t> raw(src.size() + 2 * kGuard + 1, 0xA5);
+    uint8_t* got = raw.data() + kGuard + 1;
+    if (!src.empty()) memcpy(got, src.data(), src.size());
+
+    for (size_t row = 0; row < pixels; row += rowWidth) {
+        const size_t n = pixels - row < rowWidth ? pixels - row : rowWidth;
+        convertPixelsScalar(want.data() + row * 4, n, f, premultiply);
+        convertPixels(got + row * 4, n, f, premultiply);
+    }
+
+    bool ok = src.empty() || memcmp(got, want.data(), src.size()) == 0;
+    for (size_t b = 0; b < kGuard; ++b)
+        ok = ok && raw[b + 1] == 0xA5 && got[src.size() + b] == 0xA5;
+    if (!ok && failures++ < 10)
+        printf("FAIL: %s: %s, %zu pixels in rows of %zu, %s, premultiply %d\n",
+               kPath, what, pixels, rowWidth, formatName(f), premultiply);
+}
+
+int main() {
+    // mulDiv255 is the reference for all of them, so it's checked against exact rounding
+    for (unsigned c = 0; c < 256; ++c)
+        for (unsigned a = 0; a < 256; ++a)
+            if (mulDiv255(c, a) != (unsigned)std::lround(c * a / 255.0) && failures++ < 10)
+                printf("FAIL: mulDiv255(%u, %u) = %u\n", c, a, mulDiv255(c, a));
+
+    // and the reference itself, on one pixel worked out by hand
+    uint8_t px[4] = { 10, 20, 30, 128 };
+    const uint8_t bgraPremultiplied[4] = { 15, 10, 5, 128 };
+    convertPixelsScalar(px, 1, PixelFormat::BGRA8, true);
+    if (memcmp(px, bgraPremultiplied, 4) != 0 && failures++ < 10)
+        printf("FAIL: convertPixelsScalar gave %u %u %u %u\n", px[0], px[1], px[2], px[3]);
+
+    // every color byte against every alpha, each channel a different color
+    std::vector<uint8_t> pairs(256 * 256 * 4);
+    for (unsigned c = 0; c < 256; ++c) {
+        for (unsigned a = 0; a < 256; ++a) {
+            uint8_t* px = &pairs[(c * 256 + a) * 4];
+            px[0] = (uint8_t)c;
+            px[1] = (uint8_t)(255 - c);
+            px[2] = (uint8_t)(c * 7);
+            px[3] = (uint8_t)a;
+        }
+    }
+
+    int runs = 0;
+    for (PixelFormat f : kFormats) {
+        for (bool premultiply : { false, true }) {
+            check(pairs, pairs.size() / 4, f, premultiply, "all color/alpha pairs");
+            ++runs;
+
+            // every tail length, random pixels with alpha pinned to 0 and 255 often
+            for (size_t n = 0; n < 68; ++n, ++runs) {
+                std::vector<uint8_t> px(n * 4);
+                for (size_t i = 0; i < px.size(); ++i) px[i] = nextByte();
+                for (size_t i = 0; i < n; i += 3) px[i * 4 + 3] = (i & 1) ? 255 : 0;
+                check(px, n ? n : 1, f, premultiply, "tail");
+            }
+
+            // odd-width images, whole and row by row
+            for (size_t w : { 1, 3, 5, 7, 9, 15, 17, 33, 101 }) {
+                std::vector<uint8_t> px(w * 5 * 4);
+                for (uint8_t& b : px) b = nextByte();
+                check(px, px.size() / 4, f, premultiply, "odd-width image");
+                check(px, w, f, premultiply, "odd-width rows");
+                runs += 2;
+            }
+        }
+    }
+
+    printf("convertPixels (%s): %d runs checked against convertPixelsScalar: %s\n",
+           kPath, runs, failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,99 @@
+// quad_batch_test: expandQuads() must match expandQuadsScalar() bit for bit.
+//
+// Built twice: once natively (SSE2 on x86, NEON on ARM) and once with
+// SUBA_SIMD_SCALAR, so the fallback in simd.h is checked too.  Every count
+// from 0 to 67 plus a few large odd ones, none of them necessarily a
+// multiple of the vector width, with the output off 16-byte alignment and a
+// guard band behind it that must come back untouched.
+
+#include "quad_batch.h"
+#include "simd.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#if SUBA_SIMD_SSE2
+static const char* kPath = "sse2";
+#elif SUBA_SIMD_NEON
+static const char* kPath = "neon";
+#else
+static const char* kPath = "scalar";
+#endif
+
+static uint32_t seed = 12345;
+static uint32_t next() { return seed = seed * 1664525u + 1013904223u; }
+
+// mostly ordinary coordinates, with -0, NaN, inf and denormals mixed in
+static float value() {
+    switch (next() % 16) {
+    case 0: return -0.0f;
+    case 1: return std::numeric_limits<float>::quiet_NaN();
+    case 2: return -std::numeric_limits<float>::infinity();
+    case 3: return std::numeric_limits<float>::denorm_min();
+    default: return (float)(int32_t)next() / 65536.0f;
+    }
+}
+
+static Quad randomQuad() {
+    Quad q;
+    for (float& v : q.verts) v = value();
+    for (float& v : q.uvs) v = value();
+    for (uint32_t& c : q.colors) c = next();
+    return q;
+}
+
+static bool check(size_t n) {
+    static constexpr size_t kGuard = 3; // vertices either side of the output
+    std::vector<Quad> quads(n);
+    for (Quad& q : quads) q = randomQuad();
+
+    std::vector<QuadVertex> want(n * kVertsPerQuad);
+    expandQuadsScalar(quads.data(), n, want.data());
+
+    // 4 bytes into a fresh allocation: float aligned, but off any 16-byte boundary
+    std::vector<unsigned char> raw((n * kVertsPerQuad + 2 * kGuard) * sizeof(QuadVertex) + 4, 0xA5);
+    QuadVertex* got = reinterpret_cast<QuadVertex*>(raw.data() + 4) + kGuard;
+    expandQuads(quads.data(), n, got);
+
+    if (n && memcmp(got, want.data(), want.size() * sizeof(QuadVertex)) != 0) {
+        printf("FAIL: %s: %zu quads differ from the scalar reference\n", kPath, n);
+        return false;
+    }
+    const unsigned char* before = raw.data() + 4;
+    const unsigned char* after = reinterpret_cast<const unsigned char*>(got + n * kVertsPerQuad);
+    for (size_t b = 0; b < kGuard * sizeof(QuadVertex); ++b) {
+        if (before[b] != 0xA5 || after[b] != 0xA5) {
+            printf("FAIL: %s: %zu quads wrote outside the output\n", kPath, n);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    bool ok = true;
+    size_t tested = 0;
+    for (size_t n = 0; n < 68; ++n, ++tested) ok = check(n) && ok;
+    for (size_t n : { 255, 1001, 4097 }) {
+        ok = check(n) && ok;
+        ++tested;
+    }
+
+    // the static index pattern, against the layout documented in quad_batch.h
+    std::vector<uint16_t> idx(7 * kIndicesPerQuad);
+    fillQuadIndices(idx.data(), 7);
+    for (size_t i = 0; i < 7; ++i) {
+        const uint16_t b = (uint16_t)(i * 4), want[6] = { b, uint16_t(b + 1), uint16_t(b + 2),
+                                                          uint16_t(b + 1), uint16_t(b + 3), uint16_t(b + 2) };
+        if (memcmp(&idx[i * 6], want, sizeof(want)) != 0) {
+            printf("FAIL: quad %zu indices\n", i);
+            ok = false;
+        }
+    }
+
+    printf("expandQuads (%s): %zu counts checked against expandQuadsScalar: %s\n", kPath, tested, ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,347 @@
+// golden: render layouts offscreen and compare them with stored images.
+//
+//   golden [--update] [--tolerance T] [--max-bad N] [--size WxH] [--scale S]
+//          [--loops N] [--goldens DIR] [--out DIR] [--backend NAME ...]
+//          [--timings out.csv] [--baseline base.csv] [--max-slowdown F]
+//          [fixture.json | capture.subc ...]
+//
+// Each layout fixture (default: def.json, assets relative to the working
+// directory) is loaded with its parameter defaults and rendered offscreen by
+// every backend in this build: the GPU one ("gl" or "vk") through
+// WidgetTable::capture, and "soft" (SoftRenderer) by replaying what the GPU
+// renderer was asked to do, which is also saved as <out>/<stem>.subc.  A
+// .subc given directly is replayed on "soft" only, so machines without a
+// GPU can check captures made elsewhere.  --backend (repeatable) limits
+// the comparison to the named backends; the others still render, which the
+// soft side needs, but aren't checked.  GPU goldens depend on the driver, so
+// tests/ only checks in the soft ones, with the captures they replay.
+//
+// Images are compared with <goldens>/<stem>.<backend>.png: a pixel is bad if
+// any channel is off by more than T (default 2), and a backend fails with
+// more than N bad pixels (default 0).  A failure writes .actual.png and
+// .diff.png (bad pixels red over the dimmed golden) to --out.  --update
+// writes the goldens instead.
+//
+// Every render is also timed over --loops runs (default 20).  --timings
+// appends the medians to a CSV; against a --baseline CSV from an earlier run
+// a backend fails if its median is more than F times slower (default 1.25),
+// so batching, atlas and SIMD changes can't quietly cost time either.
+// Exit status is 1 if anything failed.
+
+#include <guikit.h>
+#include "capture_replay.h"
+#include "soft_renderer.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef USE_VULKAN
+static const char* kGpuBackend = "vk";
+#else
+static const char* kGpuBackend = "gl";
+#endif
+
+static constexpr int kMaxLoadFrames = 2000; // waiting for decodes and uploads, about 2 s
+
+struct Options {
+    bool update = false;
+    int tolerance = 2;
+    long maxBad = 0;
+    int width = 800, height = 600;
+    float scale = 1.0f;
+    int loops = 20;
+    std::string goldens; // empty: next to the fixture
+    std::string out = ".";
+    const char* timings = nullptr;
+    const char* baseline = nullptr;
+    double maxSlowdown = 1.25;
+    std::vector<std::string> backends; // empty: all
+};
+
+struct Image {
+    std::vector<uint8_t> rgba; // premultiplied, top row first
+    int width = 0, height = 0;
+};
+
+struct Timing {
+    double medianUs = 0, minUs = 0;
+};
+
+static Timing timeRuns(std::vector<uint64_t> ns) {
+    Timing t;
+    if (ns.empty()) return t;
+    std::sort(ns.begin(), ns.end());
+    t.medianUs = ns[ns.size() / 2] * 1e-3;
+    t.minUs = ns.front() * 1e-3;
+    return t;
+}
+
+static std::string stemOf(const std::string& path) {
+    size_t slash = path.find_last_of("/\\");
+    std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+    size_t dot = name.rfind('.');
+    return dot == std::string::npos ? name : name.substr(0, dot);
+}
+
+static std::string dirOf(const std::string& path) {
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? "." : path.substr(0, slash);
+}
+
+static bool endsWith(const std::string& s, const char* suffix) {
+    const size_t n = strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+static bool loadGolden(const std::string& path, Image& img) {
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (!fp) return false;
+    fclose(fp);
+    Texture t = loadPNG(path.c_str());
+    img.width = t.width;
+    img.height = t.height;
+    img.rgba.assign((uint8_t*)t.data, (uint8_t*)t.data + (size_t)t.width * t.height * 4);
+    delete[] t.data;
+    convertPixels(img.rgba.data(), (size_t)img.width * img.height, PixelFormat::RGBA8, true); // as rendered
+    return true;
+}
+
+// bad pixels red, the rest the golden at a third, so the shape of the change shows
+static void writeDiff(const std::string& path, const Image& actual, const Image& golden, int tolerance) {
+    std::vector<uint8_t> diff(golden.rgba.size());
+    for (size_t i = 0; i < diff.size(); i += 4) {
+        int worst = 0;
+        for (int c = 0; c < 4; ++c) worst = std::max(worst, std::abs((int)actual.rgba[i + c] - (int)golden.rgba[i + c]));
+        if (worst > tolerance) {
+            diff[i] = 255; diff[i + 1] = 0; diff[i + 2] = 0; diff[i + 3] = 255;
+        } else {
+            for (int c = 0; c < 3; ++c) diff[i + c] = golden.rgba[i + c] / 3;
+            diff[i + 3] = 255;
+        }
+    }
+    savePNG(path.c_str(), diff, golden.width, golden.height);
+}
+
+class Checker {
+public:
+    explicit Checker(const Options& o) : opt(o) {
+        if (opt.baseline) readBaseline(opt.baseline);
+    }
+
+    int failures = 0;
+
+    void check(const std::string& fixture, const char* backend, const Image& img, const Timing& t) {
+        if (!opt.backends.empty() && std::find(opt.backends.begin(), opt.backends.end(), backend) == opt.backends.end()) {
+            skipped(fixture, backend, "not checked (--backend)");
+            return;
+        }
+        const std::string stem = stemOf(fixture);
+        const std::string dir = opt.goldens.empty() ? dirOf(fixture) : opt.goldens;
+        const std::string golden = dir + "/" + stem + "." + backend + ".png";
+        printf("%-24s %-4s %4dx%-4d median %8.1f us  min %8.1f us  ", stem.c_str(), backend, img.width, img.height, t.medianUs, t.minUs);
+
+        int maxDiff = 0;
+        long bad = 0;
+        bool ok = true;
+        if (opt.update) {
+            ok = savePNG(golden.c_str(), img.rgba, img.width, img.height);
+            printf(ok ? "updated %s\n" : "FAIL: can't write %s\n", golden.c_str());
+        } else {
+            Image ref;
+            if (!loadGolden(golden, ref)) {
+                printf("FAIL: no %s (run with --update)\n", golden.c_str());
+                ok = false;
+            } else if (ref.width != img.width || ref.height != img.height) {
+                printf("FAIL: golden is %dx%d\n", ref.width, ref.height);
+                ok = false;
+            } else {
+                for (size_t i = 0; i < img.rgba.size(); i += 4) {
+                    int worst = 0;
+                    for (int c = 0; c < 4; ++c) worst = std::max(worst, std::abs((int)img.rgba[i + c] - (int)ref.rgba[i + c]));
+                    maxDiff = std::max(maxDiff, worst);
+                    if (worst > opt.tolerance) ++bad;
+                }
+                ok = bad <= opt.maxBad;
+                printf("%s: %ld bad pixels, max channel diff %d\n", ok ? "ok" : "FAIL", bad, maxDiff);
+                if (!ok) writeDiff(opt.out + "/" + stem + "." + backend + ".diff.png", img, ref, opt.tolerance);
+            }
+            if (!ok) savePNG((opt.out + "/" + stem + "." + backend + ".actual.png").c_str(), img.rgba, img.width, img.height);
+        }
+
+        auto base = baseline.find(stem + "," + backend);
+        if (base != baseline.end() && base->second > 0.0 && t.medianUs > base->second * opt.maxSlowdown) {
+            printf("%-24s %-4s FAIL: median %.1f us, baseline %.1f us (over %.2fx)\n", stem.c_str(), backend,
+                   t.medianUs, base->second, opt.maxSlowdown);
+            ok = false;
+        }
+        if (opt.timings) appendTiming(stem, backend, t, maxDiff, bad);
+        if (!ok) ++failures;
+    }
+
+    // a backend named by --backend that can't be checked fails, so a test can't pass by checking nothing
+    void skipped(const std::string& fixture, const char* backend, const char* why) {
+        const bool wanted = std::find(opt.backends.begin(), opt.backends.end(), backend) != opt.backends.end();
+        printf("%-24s %-4s %s: %s\n", stemOf(fixture).c_str(), backend, wanted ? "FAIL" : "skipped", why);
+        if (wanted) ++failures;
+    }
+
+private:
+    const Options& opt;
+    std::map<std::string, double> baseline; // "stem,backend" -> median us
+
+    void readBaseline(const char* path) {
+        FILE* fp = fopen(path, "r");
+        if (!fp) {
+            printf("WARNING: no baseline %s, timings aren't checked\n", path);
+            return;
+        }
+        char line[512];
+        while (fgets(line, sizeof(line), fp)) {
+            char stem[256], backend[16];
+            double median = 0;
+            if (sscanf(line, "%255[^,],%15[^,],%lf", stem, backend, &median) == 3)
+                baseline[std::string(stem) + "," + backend] = median; // a later line for the same pair wins
+        }
+        fclose(fp);
+    }
+
+    void appendTiming(const std::string& stem, const char* backend, const Timing& t, int maxDiff, long bad) {
+        FILE* fp = fopen(opt.timings, "a");
+        if (!fp) {
+            printf("WARNING: can't append to %s\n", opt.timings);
+            return;
+        }
+        fprintf(fp, "%s,%s,%.1f,%.1f,%d,%ld\n", stem.c_str(), backend, t.medianUs, t.minUs, maxDiff, bad);
+        fclose(fp);
+    }
+};
+
+// a capture on SoftRenderer: the last render-to-target is the image, then it
+// is re-run on a fresh target of the same size for timing
+static void checkSoft(const std::string& fixture, const std::string& capturePath, const Options& opt, Checker& checker) {
+    CaptureReader reader;
+    if (!reader.open(capturePath.c_str())) {
+        checker.skipped(fixture, "soft", "capture unreadable");
+        return;
+    }
+    SoftRenderer soft(opt.width, opt.height, opt.scale);
+    CaptureReplay<SoftRenderer> replay(soft, reader.pixelFormat());
+    std::map<unsigned int, std::pair<int, int>> targetSizes; // recorded id -> points
+    CaptureRecord rec, last;
+    Image img;
+    while (reader.next(rec)) {
+        if (rec.op == CaptureOp::CreateTarget) targetSizes[rec.id] = { rec.width, rec.height };
+        if (replay.apply(rec, true)) soft.drawFrame();
+        if (rec.op == CaptureOp::RenderToTarget && soft.readPixels(replay.map(rec.id), img.rgba, img.width, img.height)) {
+            last.id = rec.id;
+            last.quads = rec.quads;
+            last.tex = rec.tex; // already mapped
+        }
+    }
+    if (img.rgba.empty()) {
+        checker.skipped(fixture, "soft", "nothing was rendered offscreen in the capture");
+        return;
+    }
+
+    const std::pair<int, int> size = targetSizes[last.id];
+    const unsigned int target = soft.createRenderTarget(size.first, size.second);
+    std::vector<uint64_t> ns;
+    for (int i = 0; i < opt.loops; ++i) {
+        const uint64_t start = profiler::nowNs();
+        soft.renderToTarget(target, last.quads.data(), last.tex.data(), last.quads.size());
+        ns.push_back(profiler::nowNs() - start);
+    }
+    soft.destroyRenderTarget(target);
+    checker.check(fixture, "soft", img, timeRuns(ns));
+}
+
+// a layout on this build's GPU backend, recording what it draws for checkSoft
+static void checkLayout(const std::string& fixture, const Options& opt, Checker& checker) {
+    const std::string capturePath = opt.out + "/" + stemOf(fixture) + ".subc";
+    {
+        // a window and renderer per fixture: a new share group, so the text
+        // atlas and texture cache are created (and captured) again
+        PlatformWindow win(opt.width, opt.height, "golden");
+        Renderer renderer(win.nativeParent(), opt.width, opt.height);
+        FrameCapture capture;
+        if (capture.open(capturePath.c_str(), renderer.nativePixelFormat())) renderer.setCapture(&capture);
+
+        WidgetTable widgets = loadGUI(renderer, fixture, true);
+        widgets.resize((float)opt.width, (float)opt.height);
+        GuiParamStore params;
+        initParamDefaults(params);
+        for (uint32_t id = 0; id < kParamCount; ++id) params.markDirty(id);
+        params.consumeDirty([&widgets](uint32_t id, float value) { widgets.applyParam((int32_t)id, value); });
+
+        // art decodes off-thread and streams in over a few frames; never compare placeholders
+        for (int frame = 0; frame < kMaxLoadFrames && (textureCacheFor(renderer).loading() || renderer.uploadsPending()); ++frame) {
+            widgets.draw(renderer);
+            renderer.drawFrame();
+            win.poll();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        Image img;
+        if (!widgets.capture(renderer, (float)opt.width, (float)opt.height, opt.scale, img.rgba, img.width, img.height)) {
+            checker.skipped(fixture, kGpuBackend, "this backend can't render offscreen");
+        } else {
+            renderer.setCapture(nullptr); // one render is all the soft side needs
+            std::vector<uint64_t> ns;
+            Image again;
+            for (int i = 0; i < opt.loops; ++i) {
+                const uint64_t start = profiler::nowNs();
+                widgets.capture(renderer, (float)opt.width, (float)opt.height, opt.scale, again.rgba, again.width, again.height);
+                ns.push_back(profiler::nowNs() - start);
+            }
+            checker.check(fixture, kGpuBackend, img, timeRuns(ns));
+        }
+        renderer.setCapture(nullptr);
+    }
+    checkSoft(fixture, capturePath, opt, checker);
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    std::vector<std::string> fixtures;
+    for (int i = 1; i < argc; ++i) {
+        const bool more = i + 1 < argc;
+        if (strcmp(argv[i], "--update") == 0) opt.update = true;
+        else if (strcmp(argv[i], "--tolerance") == 0 && more) opt.tolerance = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--max-bad") == 0 && more) opt.maxBad = atol(argv[++i]);
+        else if (strcmp(argv[i], "--size") == 0 && more) sscanf(argv[++i], "%dx%d", &opt.width, &opt.height);
+        else if (strcmp(argv[i], "--scale") == 0 && more) opt.scale = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--loops") == 0 && more) opt.loops = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--goldens") == 0 && more) opt.goldens = argv[++i];
+        else if (strcmp(argv[i], "--out") == 0 && more) opt.out = argv[++i];
+        else if (strcmp(argv[i], "--timings") == 0 && more) opt.timings = argv[++i];
+        else if (strcmp(argv[i], "--baseline") == 0 && more) opt.baseline = argv[++i];
+        else if (strcmp(argv[i], "--max-slowdown") == 0 && more) opt.maxSlowdown = atof(argv[++i]);
+        else if (strcmp(argv[i], "--backend") == 0 && more) opt.backends.push_back(argv[++i]);
+        else if (argv[i][0] == '-') {
+            fprintf(stderr, "golden: unknown option %s\n", argv[i]);
+            return 2;
+        } else fixtures.push_back(argv[i]);
+    }
+    if (fixtures.empty()) fixtures.push_back("def.json");
+    if (opt.width < 1 || opt.height < 1 || opt.scale <= 0.0f) {
+        fprintf(stderr, "golden: bad --size or --scale\n");
+        return 2;
+    }
+
+    textVariables()["gVersionStr"] = "golden"; // not the build's version, which changes
+    Checker checker(opt);
+    for (const std::string& fixture : fixtures) {
+        if (endsWith(fixture, ".subc")) checkSoft(fixture, fixture, opt, checker);
+        else checkLayout(fixture, opt, checker);
+    }
+    if (checker.failures) printf("%d failed\n", checker.failures);
+    return checker.failures ? 1 : 0;
+}
@@ -0,0 +1,184 @@
+// replay: re-run a renderer capture (see capture.h) and time every frame.
+//
+//   replay [--window] [--loops N] [--png last.png] capture.subc
+//
+// Headless by default: frames are drawn by SoftRenderer on the CPU, so a
+// capture from a user's machine replays on a build box with no GPU, and the
+// same capture always gives the same image (its hash is printed; --png
+// writes it).  --window replays against this build's real backend instead,
+// presenting every frame, which is what to time when chasing a slow frame.
+//
+// Prints the quad count and the replay time per frame (mean, p50, p99,
+// worst), then the slowest frames with the input recorded just before them.
+// --loops N runs the frames N times; resources are only created on the first.
+
+#include <guikit.h>
+#include "capture_replay.h"
+#include "soft_renderer.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+static constexpr size_t kWorstFrames = 5;
+static constexpr uint64_t kInputWindowNs = 100000000; // input shown up to 100 ms before a slow frame
+
+struct FrameTiming {
+    uint64_t index = 0;
+    uint64_t recordedNs = 0; // when the app submitted it
+    size_t quads = 0;
+    uint64_t replayNs = 0;
+};
+
+static const char* eventName(uint32_t type) {
+    static const char* names[] = { "quit", "resize", "mouse down", "mouse up", "mouse move", "key down", "key up" };
+    return type < sizeof(names) / sizeof(names[0]) ? names[type] : "unknown";
+}
+
+static void printStats(std::vector<FrameTiming> frames, const std::vector<CaptureEvent>& events) {
+    if (frames.empty()) {
+        printf("no frames in the capture\n");
+        return;
+    }
+    std::vector<uint64_t> ns;
+    ns.reserve(frames.size());
+    uint64_t total = 0;
+    size_t quads = 0;
+    for (const FrameTiming& f : frames) {
+        ns.push_back(f.replayNs);
+        total += f.replayNs;
+        quads += f.quads;
+    }
+    std::sort(ns.begin(), ns.end());
+    auto pct = [&ns](double p) { return ns[std::min(ns.size() - 1, (size_t)(p * (double)ns.size()))] * 1e-3; };
+    printf("%zu frames, %.0f quads/frame: mean %.1f us, p50 %.1f us, p99 %.1f us, worst %.1f us\n",
+           frames.size(), (double)quads / frames.size(), total * 1e-3 / frames.size(), pct(0.5), pct(0.99), ns.back() * 1e-3);
+
+    std::sort(frames.begin(), frames.end(), [](const FrameTiming& a, const FrameTiming& b) { return a.replayNs > b.replayNs; });
+    frames.resize(std::min(frames.size(), kWorstFrames));
+    for (const FrameTiming& f : frames) {
+        printf("  frame %llu: %.1f us, %zu quads\n", (unsigned long long)f.index, f.replayNs * 1e-3, f.quads);
+        for (const CaptureEvent& e : events) {
+            if (!e.timeNs || e.timeNs > f.recordedNs || f.recordedNs - e.timeNs > kInputWindowNs) continue;
+            printf("    %5.1f ms before: %s", (f.recordedNs - e.timeNs) * 1e-6, eventName(e.type));
+            if (e.type == (uint32_t)EventType::Resize) printf(" %dx%d", e.width, e.height);
+            else if (e.type == (uint32_t)EventType::KeyDown || e.type == (uint32_t)EventType::KeyUp) printf(" '%c'", (char)e.character);
+            else if (e.type != (uint32_t)EventType::Quit) printf(" %d,%d", e.x, e.y);
+            printf("\n");
+        }
+    }
+}
+
+// one pass over the capture: every record applied, each frame timed
+template <typename R>
+struct Replayer {
+    Replayer(R& renderer, PixelFormat recorded) : r(renderer), replay(renderer, recorded) {}
+
+    std::vector<FrameTiming> timings;
+    std::vector<CaptureEvent> events;
+    std::function<void()> afterFrame = []() {}; // the window pumps its events here
+
+    /// false if the capture couldn't be opened
+    bool run(const char* path, bool firstPass) {
+        CaptureReader reader;
+        if (!reader.open(path)) return false;
+        CaptureRecord rec;
+        uint64_t frameIndex = 0;
+        while (reader.next(rec)) {
+            if (rec.op == CaptureOp::Event) {
+                if (firstPass) events.push_back(rec.event);
+                continue;
+            }
+            const uint64_t start = profiler::nowNs();
+            if (!replay.apply(rec, firstPass)) continue;
+            r.drawFrame();
+            timings.push_back({ frameIndex++, rec.timeNs, rec.quads.size(), profiler::nowNs() - start });
+            afterFrame();
+        }
+        return true;
+    }
+
+private:
+    R& r;
+    CaptureReplay<R> replay;
+};
+
+static uint64_t fnv1a(const std::vector<uint8_t>& bytes) {
+    uint64_t h = 1469598103934665603ull;
+    for (uint8_t b : bytes) h = (h ^ b) * 1099511628211ull;
+    return h;
+}
+
+// the first record is the size setCapture() saw; a window needs it up front
+static bool initialSize(const char* path, int& width, int& height, float& scale) {
+    CaptureReader reader;
+    CaptureRecord rec;
+    if (!reader.open(path)) return false;
+    width = 800;
+    height = 600;
+    scale = 1.0f;
+    if (reader.next(rec) && rec.op == CaptureOp::Resize && rec.width > 0 && rec.height > 0) {
+        width = rec.width;
+        height = rec.height;
+        scale = rec.scale;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    const char* pngPath = nullptr;
+    bool window = false;
+    int loops = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--window") == 0) window = true;
+        else if (strcmp(argv[i], "--loops") == 0 && i + 1 < argc) loops = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--png") == 0 && i + 1 < argc) pngPath = argv[++i];
+        else path = argv[i];
+    }
+    if (!path) {
+        fprintf(stderr, "usage: replay [--window] [--loops N] [--png last.png] capture.subc\n");
+        return 1;
+    }
+
+    int width, height;
+    float scale;
+    if (!initialSize(path, width, height, scale)) return 1;
+    CaptureReader probe;
+    probe.open(path);
+    const PixelFormat recorded = probe.pixelFormat();
+
+    if (window) {
+        PlatformWindow win(width, height, "replay");
+        Renderer renderer(win.nativeParent(), width, height);
+        Replayer<Renderer> replayer(renderer, recorded);
+        replayer.afterFrame = [&win]() { win.poll(); };
+        for (int loop = 0; loop < loops; ++loop)
+            if (!replayer.run(path, loop == 0)) return 1;
+        printStats(replayer.timings, replayer.events);
+        return 0;
+    }
+
+    SoftRenderer renderer(width, height, scale);
+    Replayer<SoftRenderer> replayer(renderer, recorded);
+    for (int loop = 0; loop < loops; ++loop)
+        if (!replayer.run(path, loop == 0)) return 1;
+    printStats(replayer.timings, replayer.events);
+
+    std::vector<uint8_t> rgba;
+    int w = 0, h = 0;
+    renderer.readFrame(rgba, w, h);
+    printf("last frame %dx%d, hash %016llx\n", w, h, (unsigned long long)fnv1a(rgba));
+    if (pngPath) {
+        if (!savePNG(pngPath, rgba, w, h)) {
+            fprintf(stderr, "replay: can't write %s\n", pngPath);
+            return 1;
+        }
+        printf("wrote %s\n", pngPath);
+    }
+    return 0;
+}
@@ -0,0 +1,177 @@
+// sdfgen: control art -> distance field for the SDF shader path.
+//
+//   sdfgen [--downscale N] [--spread S] knob.png [knob.sdf.png]
+//
+// The art's alpha is the shape (its colors are dropped; the widget's tint
+// colors it at runtime).  The output is N times smaller per side, white with
+// the signed distance to the shape's edge in alpha: 0.5 on the edge, 1 at S
+// output texels inside, 0 at S outside.  The art's own size is written to a
+// "suba-sdf" text chunk so the widget keeps its rect (see TextureCache).
+//
+// Glyph sheets go through the same way.  Give it art drawn at (or above) the
+// largest size it will be shown at; everything smaller comes out of the
+// same few kilobytes.
+
+#include <png.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static bool readRGBA(const char* path, std::vector<uint8_t>& rgba, int& w, int& h) {
+    png_image image;
+    memset(&image, 0, sizeof(image));
+    image.version = PNG_IMAGE_VERSION;
+    if (!png_image_begin_read_from_file(&image, path)) {
+        fprintf(stderr, "sdfgen: %s: %s\n", path, image.message);
+        return false;
+    }
+    image.format = PNG_FORMAT_RGBA;
+    rgba.resize(PNG_IMAGE_SIZE(image));
+    if (!png_image_finish_read(&image, nullptr, rgba.data(), 0, nullptr)) {
+        fprintf(stderr, "sdfgen: %s: %s\n", path, image.message);
+        return false;
+    }
+    w = (int)image.width;
+    h = (int)image.height;
+    return true;
+}
+
+static bool writeSDF(const char* path, const std::vector<uint8_t>& rgba, int w, int h, int artW, int artH) {
+    FILE* fp = fopen(path, "wb");
+    if (!fp) return false;
+    png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    png_infop info = png_create_info_struct(png);
+    if (setjmp(png_jmpbuf(png))) {
+        png_destroy_write_struct(&png, &info);
+        fclose(fp);
+        return false;
+    }
+    png_init_io(png, fp);
+    png_set_IHDR(png, info, w, h, 8, PNG_COLOR_TYPE_RGBA, PNG_INTERLACE_NONE,
+                 PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    char key[] = "suba-sdf";
+    char value[32];
+    snprintf(value, sizeof(value), "%d %d", artW, artH);
+    png_text text;
+    memset(&text, 0, sizeof(text));
+    text.compression = PNG_TEXT_COMPRESSION_NONE;
+    text.key = key;
+    text.text = value;
+    png_set_text(png, info, &text, 1); // written with the header, ahead of IDAT
+    png_write_info(png, info);
+    for (int y = 0; y < h; ++y) png_write_row(png, const_cast<uint8_t*>(&rgba[(size_t)y * w * 4]));
+    png_write_end(png, nullptr);
+    png_destroy_write_struct(&png, &info);
+    return fclose(fp) == 0;
+}
+
+// squared distance transform of one row/column in place (Felzenszwalb &
+// Huttenlocher): f[i] becomes min_j (f[j] + (i - j)^2)
+static void edt1d(float* f, int n, int stride, std::vector<float>& d, std::vector<int>& v, std::vector<float>& z) {
+    const float inf = 1e20f;
+    int k = 0;
+    v[0] = 0;
+    z[0] = -inf;
+    z[1] = inf;
+    auto meet = [&](int q, int p) { // where the parabolas rooted at q and p cross
+        return (float)(((double)f[q * stride] + (double)q * q - ((double)f[p * stride] + (double)p * p)) / (2.0 * (q - p)));
+    };
+    for (int q = 1; q < n; ++q) {
+        float s = meet(q, v[k]);
+        while (s <= z[k]) s = meet(q, v[--k]); // z[0] is -inf, so this stops at k == 0
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = inf;
+    }
+    k = 0;
+    for (int q = 0; q < n; ++q) {
+        while (z[k + 1] < q) ++k;
+        const int p = v[k];
+        d[q] = (float)(q - p) * (q - p) + f[p * stride];
+    }
+    for (int q = 0; q < n; ++q) f[q * stride] = d[q];
+}
+
+// distance (in pixels) from every pixel to the nearest pixel where seed is set
+static std::vector<float> distanceTo(const std::vector<uint8_t>& seed, int w, int h) {
+    std::vector<float> f(seed.size());
+    for (size_t i = 0; i < seed.size(); ++i) f[i] = seed[i] ? 0.0f : 1e20f;
+    const int n = w > h ? w : h;
+    std::vector<float> d(n);
+    std::vector<int> v(n);
+    std::vector<float> z(n + 1);
+    for (int x = 0; x < w; ++x) edt1d(&f[x], h, w, d, v, z);
+    for (int y = 0; y < h; ++y) edt1d(&f[(size_t)y * w], w, 1, d, v, z);
+    for (float& x : f) x = std::sqrt(x);
+    return f;
+}
+
+int main(int argc, char** argv) {
+    int downscale = 4;
+    float spread = 4.0f;
+    const char* in = nullptr;
+    const char* out = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--downscale") == 0 && i + 1 < argc) downscale = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--spread") == 0 && i + 1 < argc) spread = (float)atof(argv[++i]);
+        else if (!in) in = argv[i];
+        else if (!out) out = argv[i];
+    }
+    if (!in || downscale < 1 || spread <= 0.0f) {
+        fprintf(stderr, "usage: sdfgen [--downscale N] [--spread S] art.png [art.sdf.png]\n");
+        return 1;
+    }
+    std::string outPath = out ? out : std::string(in).substr(0, std::string(in).rfind('.')) + ".sdf.png";
+
+    std::vector<uint8_t> rgba;
+    int w = 0, h = 0;
+    if (!readRGBA(in, rgba, w, h)) return 1;
+    if (w % downscale || h % downscale)
+        printf("sdfgen: %dx%d is not a multiple of %d; filmstrip frames may not line up\n", w, h, downscale);
+
+    // signed distance at each pixel center, positive inside; the edge sits
+    // halfway between an inside and an outside pixel
+    std::vector<uint8_t> inside((size_t)w * h), outside((size_t)w * h);
+    for (size_t i = 0; i < inside.size(); ++i) {
+        inside[i] = rgba[i * 4 + 3] >= 128;
+        outside[i] = !inside[i];
+    }
+    std::vector<float> toOutside = distanceTo(outside, w, h), toInside = distanceTo(inside, w, h);
+    std::vector<float> sd((size_t)w * h);
+    for (size_t i = 0; i < sd.size(); ++i) sd[i] = inside[i] ? toOutside[i] - 0.5f : 0.5f - toInside[i];
+
+    // resample at the output texel centers, in output texels
+    const int ow = (w + downscale - 1) / downscale, oh = (h + downscale - 1) / downscale;
+    auto at = [&](int x, int y) {
+        x = x < 0 ? 0 : x >= w ? w - 1 : x;
+        y = y < 0 ? 0 : y >= h ? h - 1 : y;
+        return sd[(size_t)y * w + x];
+    };
+    std::vector<uint8_t> field((size_t)ow * oh * 4);
+    for (int y = 0; y < oh; ++y)
+        for (int x = 0; x < ow; ++x) {
+            const float sx = (x + 0.5f) * downscale - 0.5f, sy = (y + 0.5f) * downscale - 0.5f;
+            const int x0 = (int)std::floor(sx), y0 = (int)std::floor(sy);
+            const float fx = sx - x0, fy = sy - y0;
+            const float d = (at(x0, y0) * (1 - fx) + at(x0 + 1, y0) * fx) * (1 - fy) +
+                            (at(x0, y0 + 1) * (1 - fx) + at(x0 + 1, y0 + 1) * fx) * fy;
+            float a = 0.5f + d / downscale / (2.0f * spread);
+            a = a < 0.0f ? 0.0f : a > 1.0f ? 1.0f : a;
+            uint8_t* p = &field[((size_t)y * ow + x) * 4];
+            p[0] = p[1] = p[2] = 255;
+            p[3] = (uint8_t)(a * 255.0f + 0.5f);
+        }
+
+    if (!writeSDF(outPath.c_str(), field, ow, oh, w, h)) {
+        fprintf(stderr, "sdfgen: could not write %s\n", outPath.c_str());
+        return 1;
+    }
+    printf("%s: %dx%d -> %s %dx%d (%zu KiB -> %zu KiB as RGBA)\n", in, w, h, outPath.c_str(), ow, oh,
+           (size_t)w * h * 4 / 1024, (size_t)ow * oh * 4 / 1024);
+    return 0;
+}